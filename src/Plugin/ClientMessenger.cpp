@@ -3,6 +3,8 @@
 //#include "Locator.h"
 #include <boost\bind.hpp>
 #include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cstring>
 
 #pragma warning(push)
 #pragma warning(disable: 4267)
@@ -13,70 +15,211 @@
 
 #include "BoostIPCSharedMemoryDirectory.h"
 using namespace NullSpace::SharedMemory;
+
+//Frames are pushed as soon as they grow past this size, which bounds how much of a busy tick ends up in one queue message
+const std::size_t max_batch_bytes = 4096;
+
 ClientMessenger::ClientMessenger(boost::asio::io_service& io):
 	m_serviceVersion(),
+	m_connectionStrand(io),
 	m_sentinelTimer(io),
 	m_sentinelInterval(500),
 	m_sentinalTimeout(2000),
 	m_connectedToService(false),
 	m_hapticsStream(),
+	m_writeBuffer(512),
+	m_writeLock(),
+	m_hapticsBatchStream(),
+	m_batcher(max_batch_bytes, [this](const char* data, std::size_t size) { pushBatch(data, size); }),
 	m_systems(),
 	m_nodes(),
 	m_tracking(),
+	m_trackingSnapshot(),
+	m_trackingRefreshLock(),
+	m_lastTrackingData(),
+	m_trackingReadAt(0),
+	m_trackingHistory(),
+	m_trackingChanged(),
+	m_trackingSampler(io),
+	m_trackingSampling(false),
+	m_trackingSubscribed(false),
+	m_trackingQueriedAt(0),
 	m_bodyView()
 {
 	//First time we attempt to establish connection, do it with zero delay
 	m_sentinelTimer.expires_from_now(boost::posix_time::millisec(0));
-	m_sentinelTimer.async_wait([&](auto error) {attemptEstablishConnection(error); });
+	m_sentinelTimer.async_wait(m_connectionStrand.wrap([&](auto error) {attemptEstablishConnection(error); }));
 	static_assert(sizeof(std::time_t) == 8, "Time is wrong size");
 }
 
 
 
-boost::optional<NullSpace::SharedMemory::TrackingData> ClientMessenger::ReadTrackingData(uint32_t region) {
-	if (m_tracking && m_tracking->Size() > 0) {
-		if (auto val = m_tracking->Get([region](const auto& taggedQuat) { return taggedQuat.region == region; })) {
-			return *val;
+//The service publishes tracking well below this rate, so reading more often would only find the same data again
+const std::chrono::milliseconds tracking_refresh_interval(1);
+
+//Short enough that samples are timestamped within a couple of milliseconds of arriving
+const std::chrono::milliseconds tracking_sample_interval(2);
+
+//Games query the history every frame, so one which hasn't for this long has most likely stopped
+const std::chrono::milliseconds tracking_sampler_idle_timeout(1000);
+
+bool sameTracking(const std::vector<TrackingData>& lhs, const std::vector<TrackingData>& rhs) {
+	//Plain data straight out of shared memory, so comparing bytes is fine
+	return lhs.size() == rhs.size()
+		&& (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(TrackingData)) == 0);
+}
+
+boost::optional<TrackingSnapshot> ClientMessenger::ReadTrackingSnapshot()
+{
+	const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+	const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(tracking_refresh_interval).count();
+	if (now - m_trackingReadAt.load(std::memory_order_relaxed) >= interval) {
+		std::unique_lock<std::mutex> refreshing(m_trackingRefreshLock, std::try_to_lock);
+		if (refreshing.owns_lock()) {
+			refreshTracking(now);
 		}
 	}
 
-	return boost::none;
+	TrackingSnapshot snapshot = m_trackingSnapshot.Load();
+	if (snapshot.Sequence == 0) {
+		return boost::none;
+	}
+	return snapshot;
 }
-boost::optional<TrackingUpdate> ClientMessenger::ReadTracking()
+
+//Must hold m_trackingRefreshLock
+void ClientMessenger::refreshTracking(std::chrono::steady_clock::rep now)
 {
-	//if (m_trackingData) {
-	//	return m_trackingData->Read();
-	//}
-	//return boost::optional<TrackingUpdate>();
-
-	if (m_tracking) {
-		if (m_tracking->Size() > 0) {
-			TrackingUpdate t = {};
-
-			if (auto val = m_tracking->Get([](const auto& taggedQuat) { return taggedQuat.region == hlvr_region_middle_sternum; })) {
-				t.chest = val->quat;
-				t.chest_compass = val->compass;
-				t.chest_gravity = val->gravity;
-			}
-			if (auto val = m_tracking->Get([](const auto& taggedQuat) { return taggedQuat.region == hlvr_region_upper_arm_left; })) {
-				t.left_upper_arm = val->quat;
-				t.left_upper_arm_compass = val->compass;
-				t.left_upper_arm_gravity = val->gravity;
-			}
-			if (auto val = m_tracking->Get([](const auto& taggedQuat) { return taggedQuat.region == hlvr_region_upper_arm_right; })) {
-				t.right_upper_arm = val->quat;
-				t.right_upper_arm_compass = val->compass;
-				t.right_upper_arm_gravity = val->gravity;
+	if (!m_tracking) {
+		return;
+	}
+	m_trackingReadAt.store(now, std::memory_order_relaxed);
+
+	std::vector<TrackingData> data = m_tracking->ToVector();
+	const uint64_t sequence = m_trackingSnapshot.Load().Sequence;
+	if (sequence != 0 && sameTracking(data, m_lastTrackingData)) {
+		return;
+	}
+
+	const TrackingSnapshot snapshot(sequence + 1, data);
+	m_trackingSnapshot.Store(snapshot);
+	m_trackingHistory.Record(snapshot, std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(now)));
+	m_lastTrackingData = std::move(data);
+
+	if (m_trackingChanged) {
+		m_trackingChanged();
+	}
+}
+
+void ClientMessenger::OnTrackingChanged(std::function<void()> listener)
+{
+	std::lock_guard<std::mutex> guard(m_trackingRefreshLock);
+	m_trackingChanged = std::move(listener);
+}
+
+void ClientMessenger::SetTrackingSubscribed(bool subscribed)
+{
+	m_trackingSubscribed.store(subscribed);
+	if (subscribed) {
+		startSampleTracking();
+	}
+}
+
+bool ClientMessenger::wantsTrackingSamples() const
+{
+	if (m_trackingSubscribed.load()) {
+		return true;
+	}
+
+	const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+	const auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(tracking_sampler_idle_timeout).count();
+	return now - m_trackingQueriedAt.load(std::memory_order_relaxed) < timeout;
+}
+
+void ClientMessenger::startSampleTracking()
+{
+	if (!m_trackingSampling.exchange(true)) {
+		m_trackingSampler.get_io_service().post([this]() { scheduleSampleTracking(); });
+	}
+}
+
+void ClientMessenger::scheduleSampleTracking()
+{
+	m_trackingSampler.expires_from_now(tracking_sample_interval);
+	m_trackingSampler.async_wait([this](const boost::system::error_code& ec) {
+		if (ec) {
+			m_trackingSampling.store(false);
+			return;
+		}
+
+		ReadTrackingSnapshot();
+		if (!wantsTrackingSamples()) {
+			m_trackingSampling.store(false);
+			//Someone may have wanted samples after we checked, and seen that we were still running
+			if (!wantsTrackingSamples() || m_trackingSampling.exchange(true)) {
+				return;
 			}
+		}
+		scheduleSampleTracking();
+	});
+}
+
+boost::optional<Quaternion> ClientMessenger::ReadOrientationAt(uint32_t region, std::chrono::steady_clock::time_point at)
+{
+	m_trackingQueriedAt.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+	startSampleTracking();
 
-			return t;
+	//Picks up anything newer than the last sample first
+	ReadTrackingSnapshot();
+	return m_trackingHistory.OrientationAt(region, at);
+}
+
+boost::optional<NullSpace::SharedMemory::TrackingData> ClientMessenger::ReadTrackingData(uint32_t region) {
+	if (auto snapshot = ReadTrackingSnapshot()) {
+		if (const TrackingData* data = snapshot->Find(region)) {
+			return *data;
+		}
+
+		//Regions the snapshot had no room for are still in the data it was made from, or newer data
+		if (snapshot->Truncated) {
+			std::lock_guard<std::mutex> guard(m_trackingRefreshLock);
+			auto it = std::find_if(m_lastTrackingData.begin(), m_lastTrackingData.end(), [region](const TrackingData& data) {
+				return data.region == region;
+			});
+			if (it != m_lastTrackingData.end()) {
+				return *it;
+			}
 		}
 	}
-	
+
 	return boost::none;
-	
+}
 
+boost::optional<TrackingUpdate> ClientMessenger::ReadTracking()
+{
+	auto snapshot = ReadTrackingSnapshot();
+	if (!snapshot || snapshot->Present == 0) {
+		return boost::none;
+	}
 
+	TrackingUpdate t = {};
+	if (const TrackingData* val = snapshot->Find(hlvr_region_middle_sternum)) {
+		t.chest = val->quat;
+		t.chest_compass = val->compass;
+		t.chest_gravity = val->gravity;
+	}
+	if (const TrackingData* val = snapshot->Find(hlvr_region_upper_arm_left)) {
+		t.left_upper_arm = val->quat;
+		t.left_upper_arm_compass = val->compass;
+		t.left_upper_arm_gravity = val->gravity;
+	}
+	if (const TrackingData* val = snapshot->Find(hlvr_region_upper_arm_right)) {
+		t.right_upper_arm = val->quat;
+		t.right_upper_arm_compass = val->compass;
+		t.right_upper_arm_gravity = val->gravity;
+	}
+
+	return t;
 }
 
 std::vector<NullSpace::SharedMemory::DeviceInfo> ClientMessenger::ReadDevices()
@@ -102,11 +245,14 @@ std::vector<NullSpace::SharedMemory::NodeInfo> ClientMessenger::ReadNodes()
 
 void ClientMessenger::WriteEvent(const NullSpaceIPC::HighLevelEvent & e)
 {
-	std::string binaryData;
-	e.SerializeToString(&binaryData);
-	if (m_hapticsStream) {
+	std::lock_guard<std::mutex> guard(m_writeLock);
+	if (m_hapticsBatchStream) {
+		m_batcher.Write(e);
+	}
+	else if (m_hapticsStream) {
+		std::size_t size = m_writeBuffer.Serialize(e);
 		try {
-			m_hapticsStream->Push(binaryData.data(), e.ByteSize());
+			m_hapticsStream->Push(m_writeBuffer.data(), size);
 		}
 		catch (const boost::interprocess::interprocess_exception& e) {
 			BOOST_LOG_TRIVIAL(warning) << "[ClientMessenger] Unable to push to haptics stream! " << e.what();
@@ -114,7 +260,48 @@ void ClientMessenger::WriteEvent(const NullSpaceIPC::HighLevelEvent & e)
 	}
 }
 
+void ClientMessenger::WriteEncodedEvent(EncodedBytes head, EncodedBytes tail)
+{
+	std::lock_guard<std::mutex> guard(m_writeLock);
+	if (m_hapticsBatchStream) {
+		m_batcher.WriteEncoded(head, tail);
+	}
+	else if (m_hapticsStream) {
+		std::size_t size = m_writeBuffer.SerializeEncoded(head, tail);
+		try {
+			m_hapticsStream->Push(m_writeBuffer.data(), size);
+		}
+		catch (const boost::interprocess::interprocess_exception& e) {
+			BOOST_LOG_TRIVIAL(warning) << "[ClientMessenger] Unable to push to haptics stream! " << e.what();
+		}
+	}
+}
+
+
+void ClientMessenger::BeginBatch()
+{
+	std::lock_guard<std::mutex> guard(m_writeLock);
+	m_batcher.BeginBatch();
+}
 
+void ClientMessenger::EndBatch()
+{
+	std::lock_guard<std::mutex> guard(m_writeLock);
+	m_batcher.EndBatch();
+}
+
+//Precondition: m_writeLock is held
+void ClientMessenger::pushBatch(const char* data, std::size_t size)
+{
+	if (m_hapticsBatchStream) {
+		try {
+			m_hapticsBatchStream->Push(data, size);
+		}
+		catch (const boost::interprocess::interprocess_exception& e) {
+			BOOST_LOG_TRIVIAL(warning) << "[ClientMessenger] Unable to push to haptics batch stream! " << e.what();
+		}
+	}
+}
 
 boost::optional<std::string> ClientMessenger::ReadLog()
 {
@@ -160,11 +347,16 @@ bool ClientMessenger::ConnectedToService(HLVR_RuntimeInfo* info) const
 	
 }
 
+boost::asio::io_service::strand& ClientMessenger::GetConnectionStrand()
+{
+	return m_connectionStrand;
+}
+
 
 void ClientMessenger::startAttemptEstablishConnection()
 {
 	m_sentinelTimer.expires_from_now(m_sentinelInterval);
-	m_sentinelTimer.async_wait(boost::bind(&ClientMessenger::attemptEstablishConnection, this, boost::asio::placeholders::error));
+	m_sentinelTimer.async_wait(m_connectionStrand.wrap(boost::bind(&ClientMessenger::attemptEstablishConnection, this, boost::asio::placeholders::error)));
 }
 
 void ClientMessenger::attemptEstablishConnection(const boost::system::error_code &)
@@ -185,10 +377,27 @@ void ClientMessenger::attemptEstablishConnection(const boost::system::error_code
 	try {
 		static_assert(sizeof(char) == 1, "set char size to 1");
 
-		m_hapticsStream = std::make_unique<WritableSharedQueue>("ns-haptics-data");
+		{
+			std::lock_guard<std::mutex> guard(m_writeLock);
+			m_hapticsStream = std::make_unique<WritableSharedQueue>("ns-haptics-data");
+
+			//Only newer services create the batch queue, so failing to open it just means we send events individually
+			try {
+				m_hapticsBatchStream = std::make_unique<WritableSharedQueue>("ns-haptics-batch-data");
+			}
+			catch (const boost::interprocess::interprocess_exception&) {
+				m_hapticsBatchStream.reset();
+			}
+			m_batcher.Clear();
+		}
 		m_systems = std::make_unique<ReadableSharedVector<NullSpace::SharedMemory::DeviceInfo>>("ns-device-mem", "ns-device-data");
 		m_nodes = std::make_unique<ReadableSharedVector<NullSpace::SharedMemory::NodeInfo>>("ns-node-mem", "ns-node-data");
-		m_tracking = std::make_unique<ReadableSharedVector<NullSpace::SharedMemory::TrackingData>>("ns-tracking-mem", "ns-tracking-data");
+		{
+			std::lock_guard<std::mutex> guard(m_trackingRefreshLock);
+			m_tracking = std::make_unique<ReadableSharedVector<NullSpace::SharedMemory::TrackingData>>("ns-tracking-mem", "ns-tracking-data");
+			//A new connection's samples have nothing to do with the old one's, so don't blend across them
+			m_trackingHistory.Clear();
+		}
 		m_bodyView = std::make_unique<ReadableSharedVector<NullSpace::SharedMemory::RegionPair>>("ns-bodyview-mem", "ns-bodyview-data");
 	}
 	catch (const boost::interprocess::interprocess_exception& e) {
@@ -224,7 +433,7 @@ void ClientMessenger::attemptEstablishConnection(const boost::system::error_code
 void ClientMessenger::startMonitorConnection()
 {
 	m_sentinelTimer.expires_from_now(m_sentinelInterval);
-	m_sentinelTimer.async_wait([&](auto error) { monitorConnection(error); });
+	m_sentinelTimer.async_wait(m_connectionStrand.wrap([&](auto error) { monitorConnection(error); }));
 }
 
 void ClientMessenger::monitorConnection(const boost::system::error_code & ec)
@@ -6,9 +6,17 @@
 #include "WritableSharedQueue.h"
 #include "ReadableSharedVector.h"
 #include "SharedTypes.h"
+#include "SerializationBuffer.h"
+#include "EventBatcher.h"
+#include "TrackingSnapshot.h"
+#include "SeqLock.h"
+#include "TrackingHistory.h"
 #include <boost\optional.hpp>
 #include <boost\asio.hpp>
 #include <boost\chrono.hpp>
+#include <atomic>
+#include <functional>
+#include <mutex>
 
 #pragma warning(push)
 #pragma warning(disable : 4267)
@@ -25,20 +33,61 @@ public:
 
 	boost::optional<NullSpace::SharedMemory::TrackingData> ClientMessenger::ReadTrackingData(uint32_t region);
 
+	//All tracking data, indexed by region. The shared vector is read in a single pass at most once per refresh interval,
+	//and callers in between get a copy of the same snapshot. Never blocks, and never returns a half-updated snapshot.
+	//None if we haven't read any tracking yet.
+	boost::optional<TrackingSnapshot> ReadTrackingSnapshot();
+
+	//Where the region was (or is about to be) at the given time, blended from its recent samples. See TrackingHistory.
+	//None if the region hasn't been seen since we connected. The history is only sampled while it's being queried, so after
+	//a long pause it starts again from the first query.
+	boost::optional<NullSpace::SharedMemory::Quaternion> ReadOrientationAt(uint32_t region, std::chrono::steady_clock::time_point at);
+
+	//Called whenever a refresh finds new tracking data, on whichever thread did the refresh. 
+	//It runs while refreshing is locked, so it must be quick, and must not read tracking itself.
+	void OnTrackingChanged(std::function<void()> listener);
+
+	//While someone is subscribed to tracking changes, tracking is sampled regularly so that changes are noticed
+	//without anyone having to read. See m_trackingSampler.
+	void SetTrackingSubscribed(bool subscribed);
+
 	std::vector<NullSpace::SharedMemory::DeviceInfo> ReadDevices();
 	std::vector<NullSpace::SharedMemory::NodeInfo> ReadNodes();
 	void WriteEvent(const NullSpaceIPC::HighLevelEvent& e);
+	//Writes a HighLevelEvent which was encoded ahead of time, as two pieces which together make up the message
+	void WriteEncodedEvent(EncodedBytes head, EncodedBytes tail);
+
+	//While a batch is open, written events are collected and pushed as a single frame by EndBatch.
+	//If the service doesn't support batched frames, events are pushed one at a time as before.
+	void BeginBatch();
+	void EndBatch();
 	boost::optional<std::string> ReadLog();
 
 	std::vector<NullSpace::SharedMemory::RegionPair> ReadBodyView();
 	bool ConnectedToService(HLVR_RuntimeInfo* info) const;
 
+	//Connection monitoring runs on this strand. Housekeeping which reads the connection's shared objects from the
+	//io_service (such as log draining) should run on it too, so that it never overlaps a reconnect.
+	boost::asio::io_service::strand& GetConnectionStrand();
+
 	
 private:
 	NullSpace::SharedMemory::ServiceInfo m_serviceVersion;
 	//Write haptics to the suit using this shared queue
 	std::unique_ptr<WritableSharedQueue> m_hapticsStream;
 
+	//Events are serialized into this reused buffer before being pushed, so that writing doesn't allocate.
+	//WriteEvent is called from the IO thread as well as from game threads, so m_writeLock guards both the buffer and the stream.
+	SerializationBuffer m_writeBuffer;
+	std::mutex m_writeLock;
+
+	//Newer services also read batched frames (see EventBatcher) from this queue.
+	//If the service didn't create the queue, this stays null and we fall back to m_hapticsStream.
+	std::unique_ptr<WritableSharedQueue> m_hapticsBatchStream;
+	EventBatcher m_batcher;
+
+	void pushBatch(const char* data, std::size_t size);
+
 
 	std::unique_ptr<ReadableSharedVector<NullSpace::SharedMemory::NodeInfo>> m_nodes;
 	std::unique_ptr<ReadableSharedVector<NullSpace::SharedMemory::DeviceInfo>> m_systems;
@@ -55,10 +104,38 @@ private:
 
 	std::unique_ptr<ReadableSharedVector<NullSpace::SharedMemory::TrackingData>> m_tracking;
 
+	//Game threads read the snapshot concurrently. Whichever of them finds it stale refreshes it, unless another
+	//is already doing so; the rest carry on with the current one. m_trackingRefreshLock makes the refresher the only writer,
+	//and guards m_tracking and m_lastTrackingData.
+	SeqLock<TrackingSnapshot> m_trackingSnapshot;
+	std::mutex m_trackingRefreshLock;
+	std::vector<NullSpace::SharedMemory::TrackingData> m_lastTrackingData;
+	std::atomic<std::chrono::steady_clock::rep> m_trackingReadAt;
+
+	//Every refresh which finds new data is recorded here, timestamped with when it was read. Game threads only read
+	//at their frame rate, so a timer also refreshes regularly from the io_service to keep the timestamps close to
+	//when the data actually arrived.
+	TrackingHistory m_trackingHistory;
+	std::function<void()> m_trackingChanged;
+
+	//The sampling timer only runs while it's needed: while someone is subscribed, or while the history has been
+	//queried recently. It starts on the first query or subscription, and stops itself once neither is true.
+	//m_trackingSampling is set while it runs, so that only one caller starts it; only its own handler touches the timer.
+	boost::asio::steady_timer m_trackingSampler;
+	std::atomic<bool> m_trackingSampling;
+	std::atomic<bool> m_trackingSubscribed;
+	std::atomic<std::chrono::steady_clock::rep> m_trackingQueriedAt;
+
+	void refreshTracking(std::chrono::steady_clock::rep now);
+	bool wantsTrackingSamples() const;
+	void startSampleTracking();
+	void scheduleSampleTracking();
+
 
 
 	std::unique_ptr<ReadableSharedVector<NullSpace::SharedMemory::RegionPair>> m_bodyView;
 	//We use a sentinel to see if the driver is responsive/exists
+	boost::asio::io_service::strand m_connectionStrand;
 	boost::asio::deadline_timer m_sentinelTimer;
 
 	//How often we read the sentinel
@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "DeviceRegistry.h"
+
+#include <cstring>
+
+using NullSpace::SharedMemory::DeviceInfo;
+using NullSpace::SharedMemory::NodeInfo;
+
+//Plain data straight out of shared memory, so comparing bytes is fine
+template<typename T>
+static bool sameContents(const std::vector<T>& lhs, const std::vector<T>& rhs) {
+	return lhs.size() == rhs.size()
+		&& (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0);
+}
+
+static HLVR_DeviceInfo toDeviceInfo(const DeviceInfo& device) {
+	HLVR_DeviceInfo info = { 0 };
+	static_assert(sizeof(info.Name) == sizeof(device.DeviceName), "Device names should be the same size");
+	std::memcpy(info.Name, device.DeviceName, sizeof(info.Name));
+	info.Status = static_cast<HLVR_DeviceStatus>(device.Status);
+	info.Id = device.Id;
+	info.Concept = static_cast<HLVR_DeviceConcept>(device.Concept);
+	return info;
+}
+
+static HLVR_NodeInfo toNodeInfo(const NodeInfo& node) {
+	HLVR_NodeInfo info = { 0 };
+	static_assert(sizeof(info.Name) == sizeof(node.NodeName), "Node names should be the same size");
+	std::memcpy(info.Name, node.NodeName, sizeof(info.Name));
+	info.Id = node.Id;
+	info.Concept = static_cast<HLVR_NodeConcept>(node.Type);
+	return info;
+}
+
+DeviceRegistry::DeviceRegistry(ReadDevices readDevices, ReadNodes readNodes, std::chrono::milliseconds refreshInterval)
+	: m_readDevices(std::move(readDevices))
+	, m_readNodes(std::move(readNodes))
+	, m_refreshInterval(refreshInterval)
+	, m_lock()
+	, m_snapshot(std::make_shared<const Snapshot>())
+	, m_lastDevices()
+	, m_lastNodes()
+	, m_readAt()
+	, m_everRead(false)
+{
+}
+
+std::shared_ptr<const DeviceRegistry::Snapshot> DeviceRegistry::Current()
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	const auto now = std::chrono::steady_clock::now();
+	if (m_everRead && now - m_readAt < m_refreshInterval) {
+		return m_snapshot;
+	}
+	m_readAt = now;
+	m_everRead = true;
+
+	std::vector<DeviceInfo> devices = m_readDevices();
+	std::vector<NodeInfo> nodes = m_readNodes();
+	if (m_snapshot->Version != 0 && sameContents(devices, m_lastDevices) && sameContents(nodes, m_lastNodes)) {
+		return m_snapshot;
+	}
+
+	auto snapshot = std::make_shared<Snapshot>();
+	snapshot->Version = m_snapshot->Version + 1;
+
+	snapshot->Devices.reserve(devices.size());
+	for (const auto& device : devices) {
+		snapshot->Devices.push_back(toDeviceInfo(device));
+	}
+
+	snapshot->Nodes.reserve(nodes.size());
+	for (const auto& node : nodes) {
+		const HLVR_NodeInfo info = toNodeInfo(node);
+		snapshot->Nodes.push_back(info);
+		snapshot->NodesByDevice[node.DeviceId].push_back(info);
+	}
+
+	m_snapshot = std::move(snapshot);
+	m_lastDevices = std::move(devices);
+	m_lastNodes = std::move(nodes);
+	return m_snapshot;
+}
+
+std::shared_ptr<const std::vector<HLVR_DeviceInfo>> DeviceRegistry::Devices()
+{
+	auto snapshot = Current();
+	return std::shared_ptr<const std::vector<HLVR_DeviceInfo>>(snapshot, &snapshot->Devices);
+}
+
+std::shared_ptr<const std::vector<HLVR_NodeInfo>> DeviceRegistry::Nodes(uint32_t deviceId)
+{
+	//Shared by every device without nodes, so that asking about one doesn't allocate
+	static const std::vector<HLVR_NodeInfo> no_nodes;
+
+	auto snapshot = Current();
+	if (deviceId == hlvr_allnodes) {
+		return std::shared_ptr<const std::vector<HLVR_NodeInfo>>(snapshot, &snapshot->Nodes);
+	}
+
+	auto nodes = snapshot->NodesByDevice.find(deviceId);
+	if (nodes == snapshot->NodesByDevice.end()) {
+		return std::shared_ptr<const std::vector<HLVR_NodeInfo>>(snapshot, &no_nodes);
+	}
+	return std::shared_ptr<const std::vector<HLVR_NodeInfo>>(snapshot, &nodes->second);
+}
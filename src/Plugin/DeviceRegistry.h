@@ -0,0 +1,57 @@
+#pragma once
+
+#include "SharedTypes.h"
+#include "HLVR.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//The devices and nodes the service knows about, converted to their API types once per change rather than once per enumeration.
+//
+//The service's shared vectors carry no generation counter, so the registry reads them at most once per refresh interval and
+//compares the bytes against what it read last time. Only when they differ does it build a new snapshot and bump the version.
+//Snapshots are immutable, so iterators can hold one and walk it without copying or locking anything.
+class DeviceRegistry {
+public:
+	struct Snapshot {
+		//Changes whenever the devices or nodes do. 0 until the first read.
+		uint64_t Version;
+		std::vector<HLVR_DeviceInfo> Devices;
+		//Every node, in the order the service lists them
+		std::vector<HLVR_NodeInfo> Nodes;
+		std::unordered_map<uint32_t, std::vector<HLVR_NodeInfo>> NodesByDevice;
+	};
+
+	using ReadDevices = std::function<std::vector<NullSpace::SharedMemory::DeviceInfo>()>;
+	using ReadNodes = std::function<std::vector<NullSpace::SharedMemory::NodeInfo>()>;
+
+	DeviceRegistry(ReadDevices readDevices, ReadNodes readNodes, std::chrono::milliseconds refreshInterval);
+
+	DeviceRegistry(const DeviceRegistry&) = delete;
+	DeviceRegistry& operator=(const DeviceRegistry&) = delete;
+
+	//Never null. May be called from any thread.
+	std::shared_ptr<const Snapshot> Current();
+
+	//Views into the current snapshot, which they keep alive
+	std::shared_ptr<const std::vector<HLVR_DeviceInfo>> Devices();
+	//hlvr_allnodes means every node, regardless of device
+	std::shared_ptr<const std::vector<HLVR_NodeInfo>> Nodes(uint32_t deviceId);
+
+private:
+	ReadDevices m_readDevices;
+	ReadNodes m_readNodes;
+	std::chrono::milliseconds m_refreshInterval;
+
+	std::mutex m_lock;
+	std::shared_ptr<const Snapshot> m_snapshot;
+	std::vector<NullSpace::SharedMemory::DeviceInfo> m_lastDevices;
+	std::vector<NullSpace::SharedMemory::NodeInfo> m_lastNodes;
+	std::chrono::steady_clock::time_point m_readAt;
+	bool m_everRead;
+};
@@ -0,0 +1,108 @@
+#include "stdafx.h"
+#include "EffectCache.h"
+
+#include <algorithm>
+
+EffectCache::EffectCache(std::size_t capacity)
+	: m_entries()
+	, m_capacity(std::max<std::size_t>(1, capacity))
+	, m_useCounter(0)
+	, m_lock()
+	, m_hits(0)
+	, m_misses(0)
+{
+	m_entries.reserve(m_capacity);
+}
+
+std::shared_ptr<const EffectProgram> EffectCache::GetOrCompile(const EventDigest& digest, const Events& events)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		if (auto program = find(digest, events.size())) {
+			m_hits++;
+			return program;
+		}
+	}
+
+	//Compiling is the expensive part, so it happens outside the lock. If two threads miss on the same events at 
+	//once, both compile, and the second insert replaces the first.
+	auto program = EffectProgram::Compile(events);
+	if (!program) {
+		return nullptr;
+	}
+	m_misses++;
+
+	std::lock_guard<std::mutex> guard(m_lock);
+	insert(digest, events.size(), program);
+	return program;
+}
+
+std::shared_ptr<const EffectProgram> EffectCache::GetOrCompile(const Events& events)
+{
+	return GetOrCompile(Digest(events), events);
+}
+
+uint64_t EffectCache::Hits() const
+{
+	return m_hits.load();
+}
+
+uint64_t EffectCache::Misses() const
+{
+	return m_misses.load();
+}
+
+std::size_t EffectCache::size() const
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_entries.size();
+}
+
+void EffectCache::Clear()
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	m_entries.clear();
+}
+
+EventDigest EffectCache::Digest(const Events& events)
+{
+	EventDigester digester;
+	for (const auto& event : events) {
+		digester.Add(event.Time, event.Data);
+	}
+	return digester.Digest();
+}
+
+std::shared_ptr<const EffectProgram> EffectCache::find(const EventDigest& digest, std::size_t eventCount)
+{
+	for (Entry& entry : m_entries) {
+		if (entry.digest == digest && entry.eventCount == eventCount) {
+			entry.lastUsed = ++m_useCounter;
+			return entry.program;
+		}
+	}
+
+	return nullptr;
+}
+
+void EffectCache::insert(const EventDigest& digest, std::size_t eventCount, std::shared_ptr<const EffectProgram> program)
+{
+	//Keyed by the digest alone, so that timelines which collide on it replace each other rather than both being cached
+	for (Entry& entry : m_entries) {
+		if (entry.digest == digest) {
+			entry.eventCount = eventCount;
+			entry.program = std::move(program);
+			entry.lastUsed = ++m_useCounter;
+			return;
+		}
+	}
+
+	if (m_entries.size() < m_capacity) {
+		m_entries.push_back(Entry{ digest, eventCount, std::move(program), ++m_useCounter });
+		return;
+	}
+
+	auto by_last_used = [](const Entry& lhs, const Entry& rhs) { return lhs.lastUsed < rhs.lastUsed; };
+	Entry& oldest = *std::min_element(m_entries.begin(), m_entries.end(), by_last_used);
+	oldest = Entry{ digest, eventCount, std::move(program), ++m_useCounter };
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "EffectProgram.h"
+#include "EventList.h"
+#include "EventDigest.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Compiled programs for recently transmitted timelines, keyed by the digest of their events. Transmitting a timeline
+//with the same digest as one in the cache reuses its program instead of parsing, sorting and compacting the events again.
+//Entries hold only the digest, the number of events and the program, so a lookup never touches the events, whatever 
+//their size. A hit needs both the digest and the count to match. Timelines which collide on both share a program;
+//see EventDigest for how unlikely that is. Timelines which only collide on the digest take turns in the one entry.
+//When full, the least recently used program is evicted; effects which are still using it keep it alive.
+//This class is thread safe.
+class EffectCache {
+public:
+	using Events = std::vector<TimeOffset<TypedEvent>>;
+
+	static const std::size_t default_capacity = 64;
+
+	explicit EffectCache(std::size_t capacity = default_capacity);
+
+	//Returns the cached program for the digest, compiling the events and caching the result on a miss.
+	//Returns null if none of the events were playable.
+	std::shared_ptr<const EffectProgram> GetOrCompile(const EventDigest& digest, const Events& events);
+
+	//Same, for events which don't come with a digest. Digesting them costs a pass over every parameter.
+	std::shared_ptr<const EffectProgram> GetOrCompile(const Events& events);
+
+	uint64_t Hits() const;
+	//Counts the programs which were compiled because they weren't cached
+	uint64_t Misses() const;
+	std::size_t size() const;
+
+	void Clear();
+
+	static EventDigest Digest(const Events& events);
+
+private:
+	struct Entry {
+		EventDigest digest;
+		std::size_t eventCount;
+		std::shared_ptr<const EffectProgram> program;
+		uint64_t lastUsed;
+	};
+
+	std::vector<Entry> m_entries;
+	std::size_t m_capacity;
+	uint64_t m_useCounter;
+	mutable std::mutex m_lock;
+
+	std::atomic<uint64_t> m_hits;
+	std::atomic<uint64_t> m_misses;
+
+	std::shared_ptr<const EffectProgram> find(const EventDigest& digest, std::size_t eventCount);
+	void insert(const EventDigest& digest, std::size_t eventCount, std::shared_ptr<const EffectProgram> program);
+};
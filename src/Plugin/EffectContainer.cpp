@@ -1,51 +1,146 @@
 #include "stdafx.h"
 #include "EffectContainer.h"
-#include <experimental/unordered_map>
-#include <numeric>
+
+//The schedule is kept at millisecond resolution. Events are rounded up to the next tick so that they never fire 
+//early, and the clock is rounded down to the current tick.
+uint64_t dueTick(PlayerTime time)
+{
+	const int64_t micros = std::max<int64_t>(0, time.count());
+	return static_cast<uint64_t>((micros + 999) / 1000);
+}
+
+uint64_t currentTick(PlayerTime time)
+{
+	return static_cast<uint64_t>(std::max<int64_t>(0, time.count()) / 1000);
+}
+
 EffectContainer::EffectContainer()
-	: m_currentHandle{0}
-	, m_effects{}
+	: m_effects{}
 	, m_frozenEffects{}
+	, m_activeEffects{}
+	, m_releasedEffects{}
+	, m_schedule{}
+	, m_staleEntries(0)
+	, m_now(0)
 {
 }
 
 EffectContainer::EffectHandle EffectContainer::CreateEffect(PlayableEffect effect)
 {
-	m_currentHandle++;
-	m_effects.insert(std::make_pair(m_currentHandle, std::move(effect)));
-	return m_currentHandle;
+	return m_effects.Insert(std::move(effect));
 }
 
 void EffectContainer::garbageCollect()
 {
-	std::experimental::erase_if(m_effects, [](const auto& effect) {
-		return effect.second.IsReleased() && !effect.second.IsPlaying();
-	});
+	std::size_t i = 0;
+	while (i < m_releasedEffects.size()) {
+		const PlayableEffect* effect = find(m_releasedEffects[i]);
+		if (effect == nullptr || !effect->IsPlaying()) {
+			m_effects.Erase(m_releasedEffects[i]);
+			m_releasedEffects[i] = m_releasedEffects.back();
+			m_releasedEffects.pop_back();
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+void EffectContainer::deactivate(EffectHandle handle)
+{
+	auto it = std::find(m_activeEffects.begin(), m_activeEffects.end(), handle);
+	if (it != m_activeEffects.end()) {
+		*it = m_activeEffects.back();
+		m_activeEffects.pop_back();
+	}
+}
+
+void EffectContainer::schedule(EffectHandle handle, const PlayableEffect& effect)
+{
+	const uint32_t epoch = effect.Epoch();
+	for (std::size_t i = effect.NextEvent(); i < effect.EventCount(); i++) {
+		m_schedule.Schedule(dueTick(effect.EventDue(i)), ScheduledEvent{ handle, epoch, static_cast<uint32_t>(i) });
+	}
+
+	//Scheduled last, so that it fires after any events due on the same tick
+	m_schedule.Schedule(dueTick(effect.EndDue()), ScheduledEvent{ handle, epoch, end_of_effect });
+}
+
+void EffectContainer::unschedule(const PlayableEffect& effect)
+{
+	//The pending events, plus the end
+	m_staleEntries += effect.EventCount() - effect.NextEvent() + 1;
+
+	if (m_staleEntries > m_schedule.size() / 2) {
+		m_schedule.RemoveIf([this](const ScheduledEvent& scheduled) { return isStale(scheduled); });
+		m_staleEntries = 0;
+	}
+}
+
+bool EffectContainer::isStale(const ScheduledEvent& scheduled) const
+{
+	const PlayableEffect* effect = find(scheduled.effect);
+	return effect == nullptr || !effect->IsPlaying() || effect->Epoch() != scheduled.epoch;
+}
+
+void EffectContainer::dispatch(const ScheduledEvent& scheduled)
+{
+	if (isStale(scheduled)) {
+		m_staleEntries -= std::min<std::size_t>(m_staleEntries, 1);
+		return;
+	}
+
+	PlayableEffect* effect = find(scheduled.effect);
+	if (scheduled.event == end_of_effect) {
+		//Automatically stop when we reach the total duration of the effect. Everything else it scheduled has fired.
+		effect->Stop(Now());
+		deactivate(scheduled.effect);
+	}
+	else {
+		effect->Fire(scheduled.event);
+	}
 }
 
 void EffectContainer::Clear()
 {
+	//Paused effects need to be stopped too, so that the service cancels them
+	const PlayerTime now = Now();
 	for (auto& effect : m_effects) {
-		effect.second.Stop();
+		effect.Stop(now);
 	}
-	m_effects.clear();
+	m_effects.Clear();
+	m_frozenEffects.clear();
+	m_activeEffects.clear();
+	m_releasedEffects.clear();
+	m_schedule.Clear();
+	m_staleEntries = 0;
 }
 
 void EffectContainer::FreezeEffects()
 {
-	for (auto& effect : m_effects) {
-		if (effect.second.IsPlaying()) {
-			effect.second.Pause();
-			m_frozenEffects.push_back(effect.first);
+	const PlayerTime now = Now();
+	for (EffectHandle handle : m_activeEffects) {
+		if (PlayableEffect* effect = find(handle)) {
+			effect->Pause(now);
+			unschedule(*effect);
+			m_frozenEffects.push_back(handle);
 		}
 	}
+
+	m_activeEffects.clear();
 }
 
 void EffectContainer::ThawEffects()
 {
+	const PlayerTime now = Now();
 	for (const auto& frozen : m_frozenEffects) {
-		if (m_effects.find(frozen) != m_effects.end()) {
-			m_effects.at(frozen).Play();
+		if (PlayableEffect* effect = m_effects.Find(frozen)) {
+			bool wasPlaying = effect->IsPlaying();
+			effect->Play(now);
+			if (!wasPlaying && effect->IsPlaying()) {
+				m_activeEffects.push_back(frozen);
+				schedule(frozen, *effect);
+			}
 		}
 	}
 
@@ -55,19 +150,60 @@ void EffectContainer::ThawEffects()
 
 void EffectContainer::Update(float dt)
 {
-	for (auto& effect : m_effects) {
-		effect.second.Update(dt);
-	}
+	const PlayerTime now = Now() + toPlayerTime(dt);
+	m_now.store(now.count(), std::memory_order_relaxed);
+
+	m_schedule.Advance(currentTick(now), [this](const ScheduledEvent& scheduled) {
+		dispatch(scheduled);
+	});
 	
-	//For simplicity, we remove old effects every update. If this is ever an issue we can make it smarter.
+	//Released effects are removed once they are done playing
 	garbageCollect();
 }
 
+bool EffectContainer::Play(EffectHandle handle)
+{
+	const PlayerTime now = Now();
+	return Mutate(handle, [now](PlayableEffect& effect) { effect.Play(now); });
+}
+
+bool EffectContainer::Pause(EffectHandle handle)
+{
+	const PlayerTime now = Now();
+	return Mutate(handle, [now](PlayableEffect& effect) { effect.Pause(now); });
+}
+
+bool EffectContainer::Stop(EffectHandle handle)
+{
+	const PlayerTime now = Now();
+	return Mutate(handle, [now](PlayableEffect& effect) { effect.Stop(now); });
+}
+
+bool EffectContainer::Release(EffectHandle handle)
+{
+	return Mutate(handle, [](PlayableEffect& effect) { effect.Release(); });
+}
+
 bool EffectContainer::Mutate(EffectHandle handle, std::function<void(PlayableEffect&)> mutator)
 {
 	if (PlayableEffect* ptr = find(handle)) {
 		if (!ptr->IsReleased()) {
+			bool wasPlaying = ptr->IsPlaying();
+
 			mutator(*ptr);
+
+			if (!wasPlaying && ptr->IsPlaying()) {
+				m_activeEffects.push_back(handle);
+				schedule(handle, *ptr);
+			}
+			else if (wasPlaying && !ptr->IsPlaying()) {
+				deactivate(handle);
+				unschedule(*ptr);
+			}
+
+			if (ptr->IsReleased()) {
+				m_releasedEffects.push_back(handle);
+			}
 			return true;
 		}
 	}
@@ -82,9 +218,7 @@ const PlayableEffect * EffectContainer::Get(EffectHandle handle) const
 
 std::size_t EffectContainer::GetNumReleased() const
 {
-	return std::accumulate(m_effects.begin(), m_effects.end(), 0, [](int total, const auto& effect) {
-		return effect.second.IsReleased() ? total + 1 : total;
-	});
+	return m_releasedEffects.size();
 }
 
 std::size_t EffectContainer::GetNumLive() const
@@ -92,17 +226,18 @@ std::size_t EffectContainer::GetNumLive() const
 	return m_effects.size() - GetNumReleased();
 }
 
-const PlayableEffect * EffectContainer::find(EffectHandle handle) const
+PlayerTime EffectContainer::Now() const
 {
-	if (m_effects.find(handle) != m_effects.end()) {
-		return &m_effects.at(handle);
-	}
+	return PlayerTime(m_now.load(std::memory_order_relaxed));
+}
 
-	return nullptr;
+const PlayableEffect * EffectContainer::find(EffectHandle handle) const
+{
+	return m_effects.Find(handle);
 }
 
 PlayableEffect * EffectContainer::find(EffectHandle handle)
 {
-	return const_cast<PlayableEffect*>(static_cast<const EffectContainer*>(this)->find(handle));
+	return m_effects.Find(handle);
 
 }
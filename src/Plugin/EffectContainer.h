@@ -1,8 +1,10 @@
 #pragma once
 
 #include "PlayableEffect.h"
+#include "SlotMap.h"
+#include "TimerWheel.h"
 
-#include <unordered_map>
+#include <atomic>
 
 //This class is not thread safe; synchronization must happen at a higher level
 class EffectContainer {
@@ -17,20 +19,59 @@ public:
 	
 	void Update(float dt);
 
+	bool Play(EffectHandle handle);
+	bool Pause(EffectHandle handle);
+	bool Stop(EffectHandle handle);
+	bool Release(EffectHandle handle);
+
 	bool Mutate(EffectHandle handle, std::function<void(PlayableEffect&)>);
 	const PlayableEffect* Get(EffectHandle handle) const;
 
 	std::size_t GetNumReleased() const;
 	std::size_t GetNumLive() const;
+
+	//The player's clock. Safe to read from any thread.
+	PlayerTime Now() const;
 private:
-	EffectHandle m_currentHandle;
-	std::unordered_map<EffectHandle, PlayableEffect> m_effects;
+	//Effects are stored contiguously; handles are generation-checked so a stale handle can't reach a newer effect
+	SlotMap<PlayableEffect> m_effects;
 	std::vector<EffectHandle> m_frozenEffects;
 
+	//Effects which are currently playing. Membership only changes on play/pause/stop (through Mutate, freezing, 
+	//and thawing) and when an effect stops by itself.
+	std::vector<EffectHandle> m_activeEffects;
+
+	//Effects which have been released but not yet removed, because they were still playing
+	std::vector<EffectHandle> m_releasedEffects;
+
+	//An event (or the end) of an effect, scheduled for a particular playback of it
+	struct ScheduledEvent {
+		EffectHandle effect;
+		uint32_t epoch;
+		uint32_t event;
+	};
+
+	static const uint32_t end_of_effect = UINT32_MAX;
+
+	//Every pending event of every playing effect, by due time. Each tick only visits what comes due, so the 
+	//cost of dispatch follows the number of events firing rather than the number of effects.
+	//One wheel tick is one millisecond of player time.
+	TimerWheel<ScheduledEvent> m_schedule;
+
+	//Entries in m_schedule which belong to a playback that has since been paused or stopped. They are skipped 
+	//when they fire, and swept out once they make up half the schedule.
+	std::size_t m_staleEntries;
+
+	std::atomic<int64_t> m_now;
+
 	const PlayableEffect* find(EffectHandle handle) const;
 	PlayableEffect* find(EffectHandle handle);
 	void garbageCollect();
+	void deactivate(EffectHandle handle);
 
-};
-
+	void schedule(EffectHandle handle, const PlayableEffect& effect);
+	void unschedule(const PlayableEffect& effect);
+	void dispatch(const ScheduledEvent& scheduled);
+	bool isStale(const ScheduledEvent& scheduled) const;
 
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+//Hands out the 64-bit ids which the service uses to tell effects apart (the parent_id of every event an effect sends).
+//The high half is a salt picked once per session, so that ids from different sessions talking to the same service
+//don't run into each other. The low half counts up, so within a session every id is unique for the first 2^32 effects,
+//and allocating one is a single atomic increment.
+//
+//Next may be called from any thread.
+class EffectIdAllocator {
+public:
+	explicit EffectIdAllocator(uint32_t salt)
+		: m_salt(static_cast<uint64_t>(salt) << 32)
+		, m_next(1) //0 is what the service sees when no id was sent at all
+	{
+	}
+
+	EffectIdAllocator(const EffectIdAllocator&) = delete;
+	EffectIdAllocator& operator=(const EffectIdAllocator&) = delete;
+
+	uint64_t Next() {
+		uint32_t counter = m_next.fetch_add(1, std::memory_order_relaxed);
+		if (counter == 0) {
+			//Wrapped around; skip the reserved value rather than hand out a bare salt
+			counter = m_next.fetch_add(1, std::memory_order_relaxed);
+		}
+		return m_salt | counter;
+	}
+
+	uint32_t Salt() const {
+		return static_cast<uint32_t>(m_salt >> 32);
+	}
+
+	//Pays for the random device once, rather than on every effect
+	static uint32_t RandomSalt() {
+		std::random_device device;
+		return device();
+	}
+
+private:
+	const uint64_t m_salt;
+	std::atomic<uint32_t> m_next;
+};
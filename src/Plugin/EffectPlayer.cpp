@@ -13,141 +13,442 @@
 #include <numeric>
 #include <functional>
 #include <chrono>
+#include <iterator>
 
 
 
 EffectPlayer::EffectPlayer(boost::asio::io_service& io, ClientMessenger& messenger)
 	: m_messenger(messenger)
 	, m_container()
-	, m_updateHapticsInterval(boost::posix_time::millisec(5))
+	, m_updateIntervalMicros(5000)
 	, m_updateHaptics(io)
+	, m_nextTick()
+	, m_lastTick()
+	, m_tickLateness()
+	, m_timestepError()
+	, m_tickLock()
+	, m_dedicatedThread()
+	, m_timerEpoch(0)
 	, m_playerPaused(false)
-	, m_generateUuid()
+	, m_effectIds(EffectIdAllocator::RandomSalt())
 	, m_effectsLock()
+	, m_commands(1024)
+	, m_overflowLock()
+	, m_overflow()
+	, m_overflowing(false)
+	, m_handlesLock()
+	, m_liveEffects()
+	, m_liveHandles()
+	, m_containerHandles()
+	, m_numLive(0)
+	, m_numReleased(0)
 {	
 }
 
+EffectPlayer::~EffectPlayer()
+{
+	//The thread is declared before the state its tick touches, so it has to be stopped here rather than
+	//left to member destruction, in case the owner never called stop()
+	stopDedicatedThread();
+}
+
 void EffectPlayer::start() 
 {
+	std::lock_guard<std::mutex> guard(m_tickLock);
+	m_lastTick = std::chrono::steady_clock::now();
+	m_nextTick = m_lastTick;
 	scheduleTimestep();
 }
 
 
 void EffectPlayer::stop()
 {
+	stopDedicatedThread();
+
+	{
+		//Commands such as a final ClearAll may still be waiting for a tick that will never come
+		std::lock_guard<std::mutex> guard(m_effectsLock);
+		drainCommands();
+	}
+
+	std::lock_guard<std::mutex> guard(m_tickLock);
+	m_timerEpoch++;
 	m_updateHaptics.cancel();
 }
 
+HapticsThreadStatus EffectPlayer::StartDedicatedThread(const HapticsThreadOptions& options)
+{
+	//Restarting is the simplest way to apply new options
+	stopDedicatedThread();
+
+	//If another caller started a thread in the meantime, it is replaced, and joined once the lock is released
+	std::unique_ptr<HapticsThread> replaced;
+	std::lock_guard<std::mutex> guard(m_tickLock);
+	replaced = std::move(m_dedicatedThread);
+	m_timerEpoch++;
+	m_updateHaptics.cancel();
+
+	//m_nextTick is the deadline the timer was waiting for, so the thread picks up from there
+	m_dedicatedThread = std::make_unique<HapticsThread>(options, m_nextTick, [this]() {
+		std::lock_guard<std::mutex> guard(m_tickLock);
+		executeTimestep();
+		m_nextTick += GetUpdateInterval();
+		return m_nextTick;
+	});
+
+	return m_dedicatedThread->Status();
+}
+
+void EffectPlayer::StopDedicatedThread()
+{
+	if (!stopDedicatedThread()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(m_tickLock);
+	if (!m_dedicatedThread) {
+		awaitTimestep();
+	}
+}
+
+boost::optional<HapticsThreadStatus> EffectPlayer::GetDedicatedThreadStatus() const
+{
+	std::lock_guard<std::mutex> guard(m_tickLock);
+	if (!m_dedicatedThread) {
+		return boost::none;
+	}
+	return m_dedicatedThread->Status();
+}
+
+//The thread must be joined without holding m_tickLock, since its last tick may be waiting for it.
+//Returns whether there was a thread to stop.
+bool EffectPlayer::stopDedicatedThread()
+{
+	std::unique_ptr<HapticsThread> thread;
+	{
+		std::lock_guard<std::mutex> guard(m_tickLock);
+		thread = std::move(m_dedicatedThread);
+	}
+
+	const bool wasRunning = (thread != nullptr);
+	thread.reset();
+	return wasRunning;
+}
+
 void EffectPlayer::scheduleTimestep() {
-	m_updateHaptics.expires_from_now(m_updateHapticsInterval);
-	m_updateHaptics.async_wait([&](auto ec) { 
+	m_nextTick += GetUpdateInterval();
+	awaitTimestep();
+}
+
+void EffectPlayer::awaitTimestep() {
+	const uint32_t epoch = ++m_timerEpoch;
+	m_updateHaptics.expires_at(m_nextTick);
+	m_updateHaptics.async_wait([this, epoch](auto ec) { 
 		if (ec) { return; } 
-		Update(m_updateHapticsInterval.total_milliseconds() / 1000.f );
+
+		std::lock_guard<std::mutex> guard(m_tickLock);
+		if (epoch != m_timerEpoch) { return; }
+		executeTimestep();
 		scheduleTimestep();
 	});
 }
 
+void EffectPlayer::executeTimestep()
+{
+	using namespace std::chrono;
+
+	//If the process stalls (a debugger, a suspended machine), don't dump the whole gap into playback at once
+	const auto max_timestep = milliseconds(100);
+
+	const auto interval = GetUpdateInterval();
+	const auto now = steady_clock::now();
+	const auto elapsed = now - m_lastTick;
+	m_lastTick = now;
+
+	m_tickLateness.Record(duration_cast<nanoseconds>(now - m_nextTick));
+	m_timestepError.Record(duration_cast<nanoseconds>(elapsed > interval ? elapsed - interval : interval - elapsed));
+
+	Update(duration<float>(std::min<steady_clock::duration>(elapsed, max_timestep)).count());
+
+	//Having fallen several ticks behind, start again from now instead of firing the missed ticks back to back
+	if (now - m_nextTick > interval * 4) {
+		m_nextTick = now;
+	}
+}
+
+void EffectPlayer::SetUpdateInterval(std::chrono::microseconds interval)
+{
+	m_updateIntervalMicros.store(interval.count());
+}
+
+std::chrono::microseconds EffectPlayer::GetUpdateInterval() const
+{
+	return std::chrono::microseconds(m_updateIntervalMicros.load());
+}
+
+const TimingHistogram& EffectPlayer::GetTickLateness() const
+{
+	return m_tickLateness;
+}
+
+const TimingHistogram& EffectPlayer::GetTimestepError() const
+{
+	return m_timestepError;
+}
+
 
 void EffectPlayer::Update(float dt)
 {
 	std::lock_guard<std::mutex> lock_guard(m_effectsLock);
 
+	drainCommands();
+
 	if (m_playerPaused) {
 		return;
 	}
 
+	//Everything that fires during this tick goes out to the service as one frame
+	m_messenger.BeginBatch();
 	m_container.Update(dt);
+	m_messenger.EndBatch();
+
+	m_numReleased.store(m_container.GetNumReleased());
 }
 
 
 int EffectPlayer::Play(EffectHandle handle)
 {
-	return do_effect_action(m_effectsLock, handle, [](PlayableEffect& effect) { effect.Play(); });
+	return submit(handle, EffectCommand::Action::Play);
 }
 
 int EffectPlayer::Pause(EffectHandle handle)
 {
-	return do_effect_action(m_effectsLock, handle, [](PlayableEffect& effect) { effect.Pause(); });
+	return submit(handle, EffectCommand::Action::Pause);
 }
 
 int EffectPlayer::Stop(EffectHandle handle)
 {
-	return do_effect_action(m_effectsLock, handle, [](PlayableEffect& effect) { effect.Stop(); });
+	return submit(handle, EffectCommand::Action::Stop);
 }
 
 void EffectPlayer::Release(EffectHandle handle)
 {
-	do_effect_action(m_effectsLock, handle, [](PlayableEffect& effect) { effect.Release(); });
+	if (m_liveHandles.Erase(handle)) {
+		submit(EffectCommand{ EffectCommand::Action::Release, handle });
+	}
 }
 
-HLVR_Result EffectPlayer::do_effect_action(std::mutex& mutex, EffectHandle handle, std::function<void(PlayableEffect&)> fn)
+HLVR_Result EffectPlayer::submit(EffectHandle handle, EffectCommand::Action action)
 {
-	std::lock_guard<std::mutex> guard(mutex);
-	if (m_container.Mutate(handle, fn)) {
-		return HLVR_Ok;
+	if (!m_liveHandles.Contains(handle)) {
+		return HLVR_Error_NoSuchHandle;
+	}
+
+	submit(EffectCommand{ action, handle });
+	return HLVR_Ok;
+}
+
+//Queues the command for the update tick, which applies it before its next timestep. This never waits for the tick.
+void EffectPlayer::submit(EffectCommand command)
+{
+	if (!m_overflowing.load() && m_commands.TryPush(std::move(command))) {
+		return;
+	}
+
+	//The queue is only full if the tick has fallen over a thousand commands behind. Dropping the command would be
+	//worse than putting it aside, and spinning until the tick makes room would stall the game.
+	std::lock_guard<std::mutex> guard(m_overflowLock);
+	m_overflowing.store(true);
+	m_overflow.push_back(std::move(command));
+}
+
+void EffectPlayer::drainCommands()
+{
+	EffectCommand command;
+	if (!m_overflowing.load()) {
+		while (m_commands.TryPop(&command)) {
+			apply(command);
+		}
+	}
+	else {
+		//Anything still in the queue was submitted before the overflow started, so it goes first
+		std::vector<EffectCommand> commands;
+		{
+			std::lock_guard<std::mutex> guard(m_overflowLock);
+			while (m_commands.TryPop(&command)) {
+				commands.push_back(std::move(command));
+			}
+			std::move(m_overflow.begin(), m_overflow.end(), std::back_inserter(commands));
+			m_overflow.clear();
+			m_overflowing.store(false);
+		}
+
+		for (auto& overflowed : commands) {
+			apply(overflowed);
+		}
+	}
+
+	m_numReleased.store(m_container.GetNumReleased());
+}
+
+void EffectPlayer::apply(EffectCommand& command)
+{
+	if (command.action == EffectCommand::Action::Create) {
+		m_containerHandles.emplace(command.handle, m_container.CreateEffect(std::move(*command.effect)));
+		return;
+	}
+
+	//Commands for an effect which a ClearAll got to first have nothing left to act on
+	EffectContainer::EffectHandle effect = 0;
+	if (command.handle != 0) {
+		auto it = m_containerHandles.find(command.handle);
+		if (it == m_containerHandles.end()) {
+			return;
+		}
+		effect = it->second;
+	}
+
+	switch (command.action) {
+	case EffectCommand::Action::Play:
+		m_container.Play(effect);
+		break;
+	case EffectCommand::Action::Pause:
+		m_container.Pause(effect);
+		break;
+	case EffectCommand::Action::Stop:
+		m_container.Stop(effect);
+		break;
+	case EffectCommand::Action::Release:
+		if (m_container.Release(effect)) {
+			m_numLive.fetch_sub(1);
+		}
+		m_containerHandles.erase(command.handle);
+		{
+			std::lock_guard<std::mutex> guard(m_handlesLock);
+			m_liveEffects.Erase(command.handle);
+		}
+		break;
+	case EffectCommand::Action::PlayAll:
+		m_playerPaused = false;
+		m_container.ThawEffects();
+		break;
+	case EffectCommand::Action::PauseAll:
+		m_playerPaused = true;
+		m_container.FreezeEffects();
+		break;
+	case EffectCommand::Action::ClearAll:
+		//Effects whose Create is still queued behind this aren't in the container yet, so they stay counted
+		m_numLive.fetch_sub(m_container.GetNumLive());
+		m_container.Clear();
+		m_containerHandles.clear();
+		break;
+	default:
+		break;
 	}
-	return HLVR_Error_NoSuchHandle;
 }
 
 EffectHandle EffectPlayer::Create(std::vector<std::unique_ptr<PlayableEvent>> events)
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
-	
-	PlayableEffect effect(std::move(events), m_generateUuid(), m_messenger);
+	return Create(std::make_shared<const EffectProgram>(std::move(events)));
+}
 
-	return m_container.CreateEffect(std::move(effect));
+EffectHandle EffectPlayer::Create(std::shared_ptr<const EffectProgram> program)
+{
+	auto effect = std::make_unique<PlayableEffect>(std::move(program), m_effectIds.Next(), m_messenger);
+	LiveEffect live{ effect->GetProgram(), effect->GetStatus() };
+
+	//Publishing the handle and queueing the effect under one lock means a concurrent ClearAll comes either before both,
+	//and doesn't touch the effect, or after both, and clears it from the API and the tick alike
+	std::lock_guard<std::mutex> guard(m_handlesLock);
+	const EffectHandle handle = m_liveEffects.Insert(std::move(live));
+	m_liveHandles.Insert(handle);
+	m_numLive.fetch_add(1);
+	submit(EffectCommand{ EffectCommand::Action::Create, handle, std::move(effect) });
+	return handle;
 }
 
 boost::optional<EffectInfo> EffectPlayer::GetInfo(EffectHandle h) const
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
+	if (!m_liveHandles.Contains(h)) {
+		return boost::none;
+	}
+
+	std::lock_guard<std::mutex> guard(m_handlesLock);
+	const LiveEffect* live = m_liveEffects.Find(h);
+	if (live == nullptr) {
+		return boost::none;
+	}
+
+	//The container's clock is atomic, so reading it doesn't need the effects lock
+	return PlayableEffect::ReadInfo(live->program->Metadata(), *live->status, m_container.Now());
+}
+
+std::shared_ptr<const EffectMetadata> EffectPlayer::GetMetadata(EffectHandle h) const
+{
+	if (!m_liveHandles.Contains(h)) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> guard(m_handlesLock);
+	const LiveEffect* live = m_liveEffects.Find(h);
+	if (live == nullptr) {
+		return nullptr;
+	}
+
+	const auto& program = live->program;
+	return std::shared_ptr<const EffectMetadata>(program, &program->Metadata());
+}
+
+boost::optional<EffectHandle> EffectPlayer::Instantiate(EffectHandle source)
+{
+	if (!m_liveHandles.Contains(source)) {
+		return boost::none;
+	}
 
-	if (const PlayableEffect* effect = m_container.Get(h)) {
-		return effect->GetInfo();
+	std::shared_ptr<const EffectProgram> program;
+	{
+		std::lock_guard<std::mutex> guard(m_handlesLock);
+		const LiveEffect* live = m_liveEffects.Find(source);
+		if (live == nullptr) {
+			return boost::none;
+		}
+		program = live->program;
 	}
 
-	return boost::none;
+	return Create(std::move(program));
 }
 
 
 std::size_t EffectPlayer::GetNumLiveEffects() const
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
-	return m_container.GetNumLive();
+	return m_numLive.load();
 }
 
 std::size_t EffectPlayer::GetNumReleasedEffects() const
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
-	return m_container.GetNumReleased();
+	return m_numReleased.load();
 }
 
 
 
 void EffectPlayer::PlayAll()
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
-
-	m_playerPaused = false;
-	
-	m_container.ThawEffects();
+	submit(EffectCommand{ EffectCommand::Action::PlayAll, 0 });
 }
 
 
 void EffectPlayer::PauseAll()
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
-	
-	m_playerPaused = true;
-
-	m_container.FreezeEffects();
+	submit(EffectCommand{ EffectCommand::Action::PauseAll, 0 });
 }
 
 void EffectPlayer::ClearAll()
 {
-	std::lock_guard<std::mutex> guard(m_effectsLock);
-
-	m_container.Clear();
+	//See Create
+	std::lock_guard<std::mutex> guard(m_handlesLock);
+	m_liveHandles.Clear();
+	m_liveEffects.Clear();
+	submit(EffectCommand{ EffectCommand::Action::ClearAll, 0 });
 }
 
 
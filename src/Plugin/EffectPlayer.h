@@ -1,14 +1,22 @@
 #pragma once
 
 #include "EffectContainer.h"
-#include <boost/uuid/random_generator.hpp> 
+#include "MpscQueue.h"
+#include "TimingHistogram.h"
+#include "EffectIdAllocator.h"
+#include "HapticsThread.h"
+#include "LiveHandleSet.h"
+#include "SlotMap.h"
 #include <boost/functional/hash.hpp>
 #include <boost/optional.hpp>
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/deadline_timer.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 
 
@@ -17,14 +25,41 @@
 using EffectHandle = uint32_t;
 
 class PlayableEffect;
+
+//Control operations requested by API threads. API threads only ever queue them; the update tick applies them
+//at the start of each timestep.
+struct EffectCommand {
+	enum class Action {
+		Create,
+		Play,
+		Pause,
+		Stop,
+		Release,
+		PlayAll,
+		PauseAll,
+		ClearAll
+	};
+
+	Action action;
+	EffectHandle handle;
+	//Only for Create: the effect, built by the API thread so that the tick only has to move it in
+	std::unique_ptr<PlayableEffect> effect;
+};
+
 class ClientMessenger;
 class EffectPlayer
 {
 public:
 	//We need io_service for our async update loop, and ClientMessenger to write to shared memory
 	EffectPlayer(boost::asio::io_service& io, ClientMessenger& messenger);
+	//Joins the dedicated thread, if any, before the effects it ticks are destroyed
+	~EffectPlayer();
 
 	EffectHandle Create(std::vector<std::unique_ptr<PlayableEvent>> events);
+	EffectHandle Create(std::shared_ptr<const EffectProgram> program);
+
+	//Creates another effect playing the same program as the given one, with its own playback state
+	boost::optional<EffectHandle> Instantiate(EffectHandle source);
 	void Release(EffectHandle handle);
 
 	int Play(EffectHandle handle);
@@ -37,29 +72,106 @@ public:
 
 	void Update(float dt);
 
+	//Does not contend with the update tick
 	boost::optional<EffectInfo> GetInfo(EffectHandle h) const;
+	std::shared_ptr<const EffectMetadata> GetMetadata(EffectHandle h) const;
 
+	//Neither contends with the update tick. Released effects are counted as of the last tick.
 	std::size_t GetNumLiveEffects() const;
 	std::size_t GetNumReleasedEffects() const;
 
 	void start();
 	void stop();
+
+	//Moves the update tick from the io_service's timer onto a dedicated thread, or restarts that thread with new options.
+	//Returns which of the options the OS granted.
+	HapticsThreadStatus StartDedicatedThread(const HapticsThreadOptions& options);
+	//Moves the update tick back onto the io_service's timer
+	void StopDedicatedThread();
+	//Empty unless the tick is running on a dedicated thread
+	boost::optional<HapticsThreadStatus> GetDedicatedThreadStatus() const;
+
+	//Takes effect from the next tick. Safe to call from any thread.
+	void SetUpdateInterval(std::chrono::microseconds interval);
+	std::chrono::microseconds GetUpdateInterval() const;
+
+	//How late each tick woke up, relative to its deadline
+	const TimingHistogram& GetTickLateness() const;
+	//How far the measured timestep of each tick was from the configured interval
+	const TimingHistogram& GetTimestepError() const;
 private:
 	
 	ClientMessenger& m_messenger;
 	EffectContainer m_container;
 
-	boost::posix_time::millisec m_updateHapticsInterval;
-	boost::asio::deadline_timer m_updateHaptics;
+	//Ticks are scheduled against absolute deadlines on the steady clock, so wakeup jitter doesn't accumulate into 
+	//drift, and each tick advances playback by the time that really passed since the previous one.
+	std::atomic<int64_t> m_updateIntervalMicros;
+	boost::asio::steady_timer m_updateHaptics;
+	std::chrono::steady_clock::time_point m_nextTick;
+	std::chrono::steady_clock::time_point m_lastTick;
+	TimingHistogram m_tickLateness;
+	TimingHistogram m_timestepError;
+
+	//The tick runs either from m_updateHaptics or from m_dedicatedThread. m_tickLock is held by each tick, 
+	//and while switching between the two, so that ticks never overlap. A timer wait which was already 
+	//queued when the mode changed sees a stale m_timerEpoch, and doesn't run.
+	mutable std::mutex m_tickLock;
+	std::unique_ptr<HapticsThread> m_dedicatedThread;
+	uint32_t m_timerEpoch;
+
+	//Precondition: m_tickLock is held
 	void scheduleTimestep();
+	void awaitTimestep();
+	void executeTimestep();
+	bool stopDedicatedThread();
 
 
 	bool m_playerPaused;
 
-	boost::uuids::random_generator m_generateUuid;
+	//The player belongs to an Engine, so this makes one id sequence (and salt) per Engine
+	EffectIdAllocator m_effectIds;
 
+	//Guards m_container, m_containerHandles and m_playerPaused. The update tick holds it for its whole duration, so
+	//nothing called by the API takes it: commands, including creating an effect, are handed over through m_commands.
 	mutable std::mutex m_effectsLock;
-	HLVR_Result do_effect_action(std::mutex& mutex, EffectHandle handle, std::function<void(PlayableEffect&)> fn);
+	MpscQueue<EffectCommand> m_commands;
+
+	//Commands which didn't fit in m_commands, because the tick has fallen far behind. While any are waiting, every
+	//command goes here, so that they stay in order. The tick holds m_overflowLock only to take them.
+	std::mutex m_overflowLock;
+	std::vector<EffectCommand> m_overflow;
+	std::atomic<bool> m_overflowing;
+
+	struct LiveEffect {
+		std::shared_ptr<const EffectProgram> program;
+		std::shared_ptr<const PlaybackStatus> status;
+	};
+
+	//What each effect publishes about itself, so that it can be queried without the effects lock. The API's handles
+	//are this map's handles. Create and ClearAll queue their commands while holding m_handlesLock, so that the order of
+	//the queue agrees with this map. Released entries are removed by the tick, as it applies the release; the tick
+	//never holds the lock for longer than that.
+	mutable std::mutex m_handlesLock;
+	SlotMap<LiveEffect> m_liveEffects;
+
+	//Handles which the API still considers valid (created, and not yet released or cleared). Control operations
+	//check it without taking any lock.
+	LiveHandleSet<SlotMap<LiveEffect>> m_liveHandles;
+
+	//Where the tick keeps the effect behind each of the API's handles
+	std::unordered_map<EffectHandle, EffectContainer::EffectHandle> m_containerHandles;
+
+	//Live counts every effect created and not yet released or cleared by the tick. Released is published by the tick.
+	std::atomic<std::size_t> m_numLive;
+	std::atomic<std::size_t> m_numReleased;
+
+	HLVR_Result submit(EffectHandle handle, EffectCommand::Action action);
+	void submit(EffectCommand command);
+
+	//Precondition: m_effectsLock is held
+	void drainCommands();
+	void apply(EffectCommand& command);
 
 
 
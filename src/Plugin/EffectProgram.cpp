@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include "EffectProgram.h"
+
+#include <algorithm>
+
+
+EffectProgram::EffectProgram(std::vector<PlayablePtr> events)
+	: m_events()
+	, m_metadata()
+{
+	assert(!events.empty());
+
+	sortByTime(&events);
+	removeDuplicates(&events);
+
+	m_events.Reserve(events.size());
+	for (const auto& event : events) {
+		event->compact(m_events);
+	}
+
+	//Effects sharing this program send its events over and over, so do the protobuf work once here
+	m_events.Encode();
+
+	m_metadata = makeMetadata(m_events);
+}
+
+std::shared_ptr<const EffectProgram> EffectProgram::Compile(const std::vector<TimeOffset<TypedEvent>>& events)
+{
+	std::vector<PlayablePtr> playables;
+	playables.reserve(events.size());
+	for (const auto& event : events) {
+		if (auto newPlayable = PlayableEvent::make(event.Data.Type, event.Time)) {
+			newPlayable->parse(event.Data.Params); 
+			playables.push_back(std::move(newPlayable));
+		}
+	}
+
+	if (playables.empty()) {
+		return nullptr;
+	}
+
+	return std::make_shared<const EffectProgram>(std::move(playables));
+}
+
+std::shared_ptr<const EffectProgram> EffectProgram::Compile(std::vector<TimeOffset<TypedEvent>>&& events)
+{
+	std::vector<PlayablePtr> playables;
+	playables.reserve(events.size());
+	for (auto& event : events) {
+		if (auto newPlayable = PlayableEvent::make(event.Data.Type, event.Time)) {
+			newPlayable->parse(std::move(event.Data.Params)); 
+			playables.push_back(std::move(newPlayable));
+		}
+	}
+
+	if (playables.empty()) {
+		return nullptr;
+	}
+
+	return std::make_shared<const EffectProgram>(std::move(playables));
+}
+
+const EventStore& EffectProgram::Events() const
+{
+	return m_events;
+}
+
+const EffectMetadata& EffectProgram::Metadata() const
+{
+	return m_metadata;
+}
+
+//Precondition: events are sorted by time
+EffectMetadata makeMetadata(const EventStore& events)
+{
+	EffectMetadata metadata = {};
+	metadata.EventCount = events.size();
+	
+	for (std::size_t i = 0; i < events.size(); i++) {
+		float endTime = std::max(0.0f, events[i].duration + events[i].time);
+		metadata.Duration = std::max(metadata.Duration, endTime);
+		events.AppendRegions(i, &metadata.Regions);
+	}
+
+	if (!events.empty()) {
+		metadata.LastEventTime = events[events.size() - 1].time;
+	}
+
+	auto& regions = metadata.Regions;
+	std::sort(regions.begin(), regions.end());
+	regions.erase(std::unique(regions.begin(), regions.end()), regions.end());
+	regions.shrink_to_fit();
+
+	return metadata;
+}
+
+
+void sortByTime(std::vector<PlayablePtr>* playables)
+{
+	auto by_time = [](const auto& lhs, const auto& rhs) { 
+		return lhs->time() < rhs->time(); 
+	};
+	std::sort(playables->begin(), playables->end(), by_time);
+}
+
+
+void removeDuplicates(std::vector<PlayablePtr>* playables) {
+	
+	auto value_equality = [](const auto& lhs, const auto& rhs) {
+		return *lhs == *rhs;
+	};
+
+ 	auto last = std::unique(playables->begin(), playables->end(), value_equality);
+	playables->erase(last, playables->end());
+	playables->shrink_to_fit();
+}
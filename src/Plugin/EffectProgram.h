@@ -0,0 +1,50 @@
+#pragma once
+#include "PlayableEvent.h"
+#include "EventStore.h"
+#include "EventList.h"
+
+#include <memory>
+#include <vector>
+
+//Facts about an effect's timeline which never change after it is created. Computed once, up front, 
+//so that nothing needs to walk the events again.
+struct EffectMetadata {
+	//Time at which the last event finishes, in fractional seconds
+	float Duration;
+	//Time offset of the last event to start, in fractional seconds
+	float LastEventTime;
+	std::size_t EventCount;
+	//Every region targeted by some event, sorted and without duplicates
+	std::vector<uint32_t> Regions;
+};
+
+using PlayablePtr = std::unique_ptr<PlayableEvent>;
+
+void sortByTime(std::vector<PlayablePtr>* playables);
+void removeDuplicates(std::vector<PlayablePtr>* playables);
+EffectMetadata makeMetadata(const EventStore& events);
+
+//The immutable part of an effect: its events sorted, deduplicated and in compact form, plus the metadata computed
+//from them. One program can be shared by any number of effects, so nothing in here changes after construction.
+class EffectProgram {
+public:
+	//Precondition: events.size() > 0
+	//The PlayableEvents themselves aren't retained.
+	explicit EffectProgram(std::vector<PlayablePtr> events);
+
+	EffectProgram(const EffectProgram&) = delete;
+	EffectProgram& operator=(const EffectProgram&) = delete;
+
+	//Parses the events of a timeline and compiles them. Returns null if none of them were playable.
+	static std::shared_ptr<const EffectProgram> Compile(const std::vector<TimeOffset<TypedEvent>>& events);
+
+	//Same as Compile, but large parameters may be moved out of the events instead of copied
+	static std::shared_ptr<const EffectProgram> Compile(std::vector<TimeOffset<TypedEvent>>&& events);
+
+	const EventStore& Events() const;
+	const EffectMetadata& Metadata() const;
+
+private:
+	EventStore m_events;
+	EffectMetadata m_metadata;
+};
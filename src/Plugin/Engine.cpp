@@ -15,22 +15,89 @@
 #include "MyTestLog.h"
 #include "Locator.h"
 #include "BodyView.h"
+#include "TrackingSamples.h"
 #include <chrono>
 
 
-void copyQuaternion(HLVR_Quaternion& lhs, const NullSpace::SharedMemory::Quaternion& rhs);
+int Engine::SetHapticsTickInterval(uint32_t milliseconds)
+{
+	if (milliseconds < 1 || milliseconds > 20) {
+		return HLVR_Error_InvalidArgument;
+	}
 
-void copyVector3f(HLVR_Vector3f& lhs, const NullSpace::SharedMemory::Vector3& rhs);
+	m_player.SetUpdateInterval(std::chrono::milliseconds(milliseconds));
+	return HLVR_Ok;
+}
 
+void copyHistogram(uint32_t* outBuckets, const TimingHistogram& histogram)
+{
+	static_assert(TimingHistogram::num_buckets == HLVR_TIMING_HISTOGRAM_BUCKETS, "Histogram bucket counts must match");
+
+	auto buckets = histogram.Buckets();
+	for (std::size_t i = 0; i < buckets.size(); i++) {
+		outBuckets[i] = static_cast<uint32_t>(std::min<uint64_t>(buckets[i], UINT32_MAX));
+	}
+}
 
-void Engine::executeTimestep(std::chrono::milliseconds dt)
+int Engine::GetTimingStats(HLVR_TimingStats* outStats) const
 {
-	
-	constexpr auto fraction_of_second = (1.0f / 1000.f);
-	auto real_dt = dt.count() * fraction_of_second;
-	
-	m_player.Update(real_dt);
+	using fractional_ms = std::chrono::duration<float, std::milli>;
+
+	const TimingHistogram& lateness = m_player.GetTickLateness();
+
+	outStats->TickIntervalMilliseconds = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(m_player.GetUpdateInterval()).count());
+	outStats->TickCount = lateness.Count();
+	outStats->MeanLatenessMilliseconds = fractional_ms(lateness.Mean()).count();
+	outStats->MaxLatenessMilliseconds = fractional_ms(lateness.Max()).count();
+	copyHistogram(outStats->LatenessHistogram, lateness);
+	copyHistogram(outStats->TimestepErrorHistogram, m_player.GetTimestepError());
+	return HLVR_Ok;
+}
+
+int Engine::EnableRealtimeHaptics(const HLVR_RealtimeHapticsOptions* options)
+{
+	HapticsThreadOptions threadOptions = {};
+	threadOptions.RaisePriority = true;
+	threadOptions.AffinityMask = 0;
+	threadOptions.Spin = std::chrono::microseconds(1000);
+
+	if (options != nullptr) {
+		if (options->SpinMicroseconds > 5000) {
+			return HLVR_Error_InvalidArgument;
+		}
+
+		threadOptions.RaisePriority = options->RaisePriority != 0;
+		threadOptions.AffinityMask = options->AffinityMask;
+		threadOptions.Spin = std::chrono::microseconds(options->SpinMicroseconds);
+	}
+
+	m_player.StartDedicatedThread(threadOptions);
+	return HLVR_Ok;
+}
+
+int Engine::DisableRealtimeHaptics()
+{
+	m_player.StopDedicatedThread();
+	return HLVR_Ok;
+}
+
+int Engine::GetRealtimeHapticsStats(HLVR_RealtimeHapticsStats* outStats) const
+{
+	using fractional_ms = std::chrono::duration<float, std::milli>;
 
+	*outStats = {};
+	if (auto status = m_player.GetDedicatedThreadStatus()) {
+		outStats->Enabled = 1;
+		outStats->PriorityRaised = status->PriorityRaised ? 1 : 0;
+		outStats->AffinityApplied = status->AffinityApplied ? 1 : 0;
+	}
+
+	const TimingHistogram& lateness = m_player.GetTickLateness();
+	outStats->TickCount = lateness.Count();
+	outStats->LatenessP50Milliseconds = fractional_ms(lateness.Percentile(0.5)).count();
+	outStats->LatenessP99Milliseconds = fractional_ms(lateness.Percentile(0.99)).count();
+	outStats->MaxLatenessMilliseconds = fractional_ms(lateness.Max()).count();
+	return HLVR_Ok;
 }
 
 int Engine::GetInfo(uint32_t m_handle, HLVR_EffectInfo* infoPtr) const
@@ -50,64 +117,76 @@ int Engine::GetInfo(uint32_t m_handle, HLVR_EffectInfo* infoPtr) const
 
 int Engine::GetNumDevices(uint32_t * outAmount)
 {
-	*outAmount = m_messenger.ReadDevices().size();
+	*outAmount = static_cast<uint32_t>(m_deviceRegistry.Current()->Devices.size());
 	return 1;
 }
 
-HiddenIterator<HLVR_DeviceInfo>* Engine::TakeDeviceSnapshot()
+int Engine::NextDevice(HLVR_DeviceIterator* iter)
 {
-	auto systems = m_messenger.ReadDevices();
+	std::lock_guard<std::mutex> guard(m_iteratorLock);
+	if (iter->_internal == nullptr) {
+		iter->_internal = m_deviceIterators.ToInternal(m_deviceIterators.Create(m_deviceRegistry.Devices()));
+	}
 
-	std::vector<HLVR_DeviceInfo> devices;
-	for (const auto& system : systems) {
-		HLVR_DeviceInfo deviceInfo = { 0 };
-		memcpy_s(deviceInfo.Name, 128, system.DeviceName, 128);
-		deviceInfo.Status = static_cast<HLVR_DeviceStatus>(system.Status);
-		deviceInfo.Id = system.Id;
-		deviceInfo.Concept = static_cast<HLVR_DeviceConcept>(system.Concept);
-		devices.push_back(std::move(deviceInfo));
+	const auto handle = m_deviceIterators.FromInternal(iter->_internal);
+	HiddenIterator<HLVR_DeviceInfo>* iterator = m_deviceIterators.Find(handle);
+	if (iterator == nullptr) {
+		//Reclaimed to make room for newer iterators. Starting over silently could repeat devices, so say so instead.
+		iter->_internal = nullptr;
+		return HLVR_Error_NoSuchHandle;
 	}
-	
-	auto snapshot = std::make_unique<HiddenIterator<HLVR_DeviceInfo>>(devices);
-	m_deviceSnapshots.push_back(std::move(snapshot));
-	return m_deviceSnapshots.back().get();
-}
-
-HiddenIterator<HLVR_NodeInfo>* Engine::TakeNodeSnapshot(uint32_t device_id)
-{
-	auto nodes_raw = m_messenger.ReadNodes();
-	std::vector<HLVR_NodeInfo> nodes;
-	for (const auto& node : nodes_raw) {
-		//special case: they want ALL nodes, regardless of device, then specify device_id 0
-		if ((node.DeviceId) == device_id || device_id == 0) {
-			HLVR_NodeInfo nodeInfo = { 0 };
-			memcpy_s(nodeInfo.Name, 128, node.NodeName, 128);
-			nodeInfo.Id = node.Id;
-			nodeInfo.Concept = static_cast<HLVR_NodeConcept>(node.Type);
-			nodes.push_back(std::move(nodeInfo));
-		}
+
+	if (iterator->Finished()) {
+		m_deviceIterators.Destroy(handle);
+		iter->_internal = nullptr;
+		return HLVR_Error_NoMoreDevices;
 	}
 
-	auto snapshot = std::make_unique<HiddenIterator<HLVR_NodeInfo>>(nodes);
-	m_nodeSnapshots.push_back(std::move(snapshot));
-	return m_nodeSnapshots.back().get();
+	iterator->NextItem(&iter->DeviceInfo);
+	return HLVR_Ok;
 }
 
-void Engine::DestroyIterator(HiddenIterator<HLVR_DeviceInfo>* device)
+//special case: they want ALL nodes, regardless of device, then specify device_id 0
+int Engine::NextNode(HLVR_NodeIterator* iter, uint32_t device_id)
 {
-	m_deviceSnapshots.erase(
-		std::remove_if(m_deviceSnapshots.begin(), m_deviceSnapshots.end(), [device](const auto& snapshotPtr) {return snapshotPtr.get() == device; }),
-		m_deviceSnapshots.end()
-	);
+	std::lock_guard<std::mutex> guard(m_iteratorLock);
+	if (iter->_internal == nullptr) {
+		iter->_internal = m_nodeIterators.ToInternal(m_nodeIterators.Create(m_deviceRegistry.Nodes(device_id)));
+	}
+
+	const auto handle = m_nodeIterators.FromInternal(iter->_internal);
+	HiddenIterator<HLVR_NodeInfo>* iterator = m_nodeIterators.Find(handle);
+	if (iterator == nullptr) {
+		iter->_internal = nullptr;
+		return HLVR_Error_NoSuchHandle;
+	}
+
+	if (iterator->Finished()) {
+		m_nodeIterators.Destroy(handle);
+		iter->_internal = nullptr;
+		return HLVR_Error_NoMoreNodes;
+	}
+
+	iterator->NextItem(&iter->NodeInfo);
+	return HLVR_Ok;
 }
 
+void Engine::DestroyIterator(HLVR_DeviceIterator* iter)
+{
+	std::lock_guard<std::mutex> guard(m_iteratorLock);
+	if (iter->_internal != nullptr) {
+		m_deviceIterators.Destroy(m_deviceIterators.FromInternal(iter->_internal));
+		iter->_internal = nullptr;
+	}
+}
 
-void Engine::DestroyIterator(HiddenIterator<HLVR_NodeInfo>* nodes)
+void Engine::DestroyIterator(HLVR_NodeIterator* iter)
 {
-	m_nodeSnapshots.erase(
-		std::remove_if(m_nodeSnapshots.begin(), m_nodeSnapshots.end(), [nodes](const auto& snapshotPtr) {return snapshotPtr.get() == nodes; }),
-		m_nodeSnapshots.end()
-	);
+	std::lock_guard<std::mutex> guard(m_iteratorLock);
+	if (iter->_internal != nullptr) {
+		m_nodeIterators.Destroy(m_nodeIterators.FromInternal(iter->_internal));
+		iter->_internal = nullptr;
+	}
 }
 
 int Engine::StreamEvent(const TypedEvent& event)
@@ -187,20 +266,81 @@ int Engine::GetGravity(uint32_t region, HLVR_Vector3f * outGravity)
 }
 
 
+int Engine::GetAllTracking(HLVR_TrackingSample* outSamples, uint32_t capacity, uint32_t* outCount, uint64_t* inOutSequence)
+{
+	return readAllTracking(m_messenger.ReadTrackingSnapshot(), outSamples, capacity, outCount, inOutSequence);
+}
+
+//Callbacks run on the callback thread, so the samples live on its stack for the duration of the call
+int Engine::SubscribeTracking(HLVR_TrackingCallback callback, void* userData)
+{
+	assert(callback != nullptr);
+
+	m_trackingNotifier.Subscribe([callback, userData](const TrackingSnapshot& snapshot) {
+		HLVR_TrackingSample samples[HLVR_MAX_TRACKING_SAMPLES];
+		const uint32_t count = copyTrackingSamples(snapshot, samples);
+		callback(samples, count, snapshot.Sequence, userData);
+	});
+	m_messenger.SetTrackingSubscribed(true);
+	return HLVR_Ok;
+}
+
+int Engine::UnsubscribeTracking()
+{
+	m_trackingNotifier.Unsubscribe();
+	m_messenger.SetTrackingSubscribed(false);
+	return HLVR_Ok;
+}
+
+//Tracking samples are timestamped with the steady clock, so that's what callers ask about
+int Engine::GetTrackingTime(uint64_t* outMicroseconds) const
+{
+	assert(outMicroseconds != nullptr);
+
+	const auto now = std::chrono::steady_clock::now().time_since_epoch();
+	*outMicroseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+	return HLVR_Ok;
+}
+
+//precondition: outOrientation != nullptr
+int Engine::GetOrientationAt(uint32_t region, uint64_t timestampMicroseconds, HLVR_Quaternion* outOrientation)
+{
+	assert(outOrientation != nullptr);
+
+	const std::chrono::microseconds timestamp(static_cast<std::chrono::microseconds::rep>(timestampMicroseconds));
+	const std::chrono::steady_clock::time_point at(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timestamp));
+	if (auto orientation = m_messenger.ReadOrientationAt(region, at)) {
+		copyQuaternion(*outOrientation, *orientation);
+		return HLVR_Ok;
+	}
+
+	return HLVR_Error_TrackedRegionNotFound;
+}
+
+//Devices come and go on human timescales, so enumerating more often than this just finds the same ones again
+const std::chrono::milliseconds device_refresh_interval(100);
+
+//Per kind of iterator. Far more than anyone enumerates at once, but small enough that abandoned iterators can't add up.
+const std::size_t max_live_iterators = 64;
 
 Engine::Engine() :
 
 	m_isHapticsSystemPlaying(true),
 	m_ioService(),
 	m_messenger(m_ioService.GetIOService()),
-	m_player(m_ioService.GetIOService(), m_messenger),
+	m_trackingNotifier(m_ioService.GetCallbackService(), [this]() { return m_messenger.ReadTrackingSnapshot(); }),
+	m_deviceRegistry(
+		[this]() { return m_messenger.ReadDevices(); },
+		[this]() { return m_messenger.ReadNodes(); },
+		device_refresh_interval
+	),
+	m_player(m_ioService.GetHapticsService(), m_messenger),
+	m_effectCache(),
 	m_currentHandleId(0),
-	m_hapticsExecutionInterval(boost::posix_time::milliseconds(5)),
-	m_hapticsTimestep(m_ioService.GetIOService(), m_hapticsExecutionInterval),
-	m_lastHapticsTimestep(),
 	m_cachedTrackingUpdate({}),
-	m_deviceSnapshots(),
-	m_nodeSnapshots()
+	m_iteratorLock(),
+	m_deviceIterators(max_live_iterators),
+	m_nodeIterators(max_live_iterators)
 {
 
 	
@@ -211,6 +351,7 @@ Engine::Engine() :
 
 	boost::log::core::get()->set_logging_enabled(false);
 
+	m_messenger.OnTrackingChanged([this]() { m_trackingNotifier.Notify(); });
 	m_player.start();
 
 
@@ -249,7 +390,7 @@ void Engine::setupUserFacingLogSink()
 	
 	using namespace boost::log;
 	m_log = boost::make_shared<MyTestLog>();
-	m_log->Provide(&m_messenger, m_ioService.GetIOService());
+	m_log->Provide(&m_messenger, m_messenger.GetConnectionStrand());
 	
 	using sink_t = sinks::synchronous_sink<MyTestLog>;
 	boost::shared_ptr<sink_t> sink(new sink_t(m_log));
@@ -346,56 +487,78 @@ int Engine::HandleReset(uint32_t handle)
 
 
 
-std::vector<std::unique_ptr<PlayableEvent>> 
-extractPlayables(const std::vector<TimeOffset<TypedEvent>>& events) {
-	
-	using PlayablePtr = std::unique_ptr<PlayableEvent>;
-	std::vector<PlayablePtr> playables;
-	playables.reserve(events.size());
-	for (const auto& event : events) {
-		if (auto newPlayable = PlayableEvent::make(event.Data.Type, event.Time)) {
-			newPlayable->parse(event.Data.Params); 
-			playables.push_back(std::move(newPlayable));
-		}
-	}
-
-	return playables;
-}
-
 //Only modifies handle if the effect is created successfully
 int Engine::CreateEffect(const EventList * list, EffectHandle* handle)
 {
 	if (list == nullptr) {
 		return HLVR_Error_NullArgument;
 	}
+
+	//The events are read in place; on a cache hit they aren't parsed at all
+	std::shared_ptr<const EffectProgram> program;
+	bool empty = true;
+	list->WithEvents([this, &program, &empty](const EffectCache::Events& events, const EventDigest& digest) {
+		empty = events.empty();
+		if (!empty) {
+			program = m_effectCache.GetOrCompile(digest, events);
+		}
+	});
+
 	//enforces precondition on PlayableEffect to not have an empty effects list
-	if (list->empty()) {
+	if (empty) {
 		return HLVR_Error_EmptyTimeline;
 	}
-	else {
-		EffectHandle h = m_player.Create(extractPlayables(list->events()));
-		*handle = h;
-		return HLVR_Ok;
+
+	if (!program) {
+		return HLVR_Error_InvalidEventType;
+	}
+
+	*handle = m_player.Create(std::move(program));
+	return HLVR_Ok;
+}
+
+//Only modifies handle if the effect is created successfully. The list is left empty either way.
+//Timelines transmitted this way are assumed to be one-offs, so they bypass the effect cache.
+int Engine::CreateEffectConsuming(EventList * list, EffectHandle * handle)
+{
+	if (list == nullptr) {
+		return HLVR_Error_NullArgument;
 	}
 
-	return HLVR_Error_Unspecified;
+	auto events = list->TakeEvents();
+	if (events.empty()) {
+		return HLVR_Error_EmptyTimeline;
+	}
 
+	auto program = EffectProgram::Compile(std::move(events));
+	if (!program) {
+		return HLVR_Error_InvalidEventType;
+	}
 
+	*handle = m_player.Create(std::move(program));
+	return HLVR_Ok;
 }
 
+//Only modifies handle if the effect is created successfully
+int Engine::InstantiateEffect(uint32_t source, EffectHandle * handle)
+{
+	if (auto instance = m_player.Instantiate(EffectHandle(source))) {
+		*handle = *instance;
+		return HLVR_Ok;
+	}
 
- void copyQuaternion(HLVR_Quaternion& lhs, const NullSpace::SharedMemory::Quaternion& rhs) {
-	lhs.w = rhs.w;
-	lhs.x = rhs.x;
-	lhs.y = rhs.y;
-	lhs.z = rhs.z;
+	return HLVR_Error_NoSuchHandle;
 }
 
- void copyVector3f(HLVR_Vector3f& lhs, const NullSpace::SharedMemory::Vector3& rhs) {
-	lhs.x = rhs.x;
-	lhs.y = rhs.y;
-	lhs.z = rhs.z;
+int Engine::GetEffectCacheStats(HLVR_EffectCacheStats * outStats) const
+{
+	outStats->Hits = m_effectCache.Hits();
+	outStats->Misses = m_effectCache.Misses();
+	outStats->Entries = static_cast<uint32_t>(m_effectCache.size());
+	return HLVR_Ok;
 }
+
+
 void copyTracking(HLVR_TrackingUpdate& lhs, const NullSpace::SharedMemory::TrackingUpdate& rhs) {
 	copyQuaternion(lhs.chest, rhs.chest);
 	copyQuaternion(lhs.left_upper_arm, rhs.left_upper_arm);
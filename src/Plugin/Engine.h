@@ -6,39 +6,18 @@
 #include "ClientMessenger.h"
 #include <boost\asio\deadline_timer.hpp>
 #include "EffectPlayer.h"
-#include "ScheduledEvent.h"
+#include "EffectCache.h"
 #include "EventList.h"
 #include "HLVR.h"
 #include "MyTestLog.h"
 #include "HLVR_Experimental.h"
 #include "EngineCommand.h"
+#include "TrackingNotifier.h"
+#include "DeviceRegistry.h"
+#include "IteratorPool.h"
+#include <mutex>
 
 
-//The point of this is to enable the user to have something like
-// NSVR_Struct_Thing widget = {0};
-// while (NSVR_HasNext(&widget)) {
-//	//do things with widget
-// }
-// The HiddenIterator sticks itself into the void* _internal variable of the struct. 
-
-template<typename T>
-class HiddenIterator {
-public:
-	HiddenIterator(std::vector<T> items) : m_items(items) { m_currentItem = m_items.begin(); }
-	void NextItem(T* original) {
-		*original = *m_currentItem;
-		m_currentItem++;
-	}
-	bool Finished() {
-		return m_currentItem == m_items.end();
-	}
-private:
-	std::vector<T> m_items;
-	typename std::vector<T>::iterator m_currentItem;
-
-	
-};
-
 class SnapshotContainer {
 
 };
@@ -60,6 +39,9 @@ public:
 	int HandleReset(uint32_t handle);
 	void ReleaseHandle(uint32_t handle);
 	int CreateEffect(const EventList * list, EffectHandle * handle);
+	int CreateEffectConsuming(EventList * list, EffectHandle * handle);
+	int InstantiateEffect(uint32_t source, EffectHandle * handle);
+	int GetEffectCacheStats(HLVR_EffectCacheStats* outStats) const;
 	int  PollTracking(HLVR_TrackingUpdate* q);
 
 
@@ -73,43 +55,55 @@ public:
 
 	int GetNumDevices(uint32_t* outAmount);
 
-	HiddenIterator<HLVR_DeviceInfo>* TakeDeviceSnapshot();
-	HiddenIterator<HLVR_NodeInfo>* TakeNodeSnapshot(uint32_t device_id);
+	//Each iterator's first call takes a snapshot, which lives in a pool until the iterator finishes or is destroyed
+	int NextDevice(HLVR_DeviceIterator* iter);
+	int NextNode(HLVR_NodeIterator* iter, uint32_t device_id);
 
 	template<typename T>
 	bool IsFinishedIterating(HiddenIterator<T>* param1) const;
 
 	int UpdateView(BodyView* view);
-	void DestroyIterator(HiddenIterator<HLVR_DeviceInfo>* device);
-	void DestroyIterator(HiddenIterator<HLVR_NodeInfo>* nodes);
+	void DestroyIterator(HLVR_DeviceIterator* iter);
+	void DestroyIterator(HLVR_NodeIterator* iter);
 
 	int StreamEvent(const TypedEvent& event);
 	int EnableTracking(uint32_t device_id);
 	int DisableTracking(uint32_t device_id);
 
+	int SetHapticsTickInterval(uint32_t milliseconds);
+	int GetTimingStats(HLVR_TimingStats* outStats) const;
+
+	//Null options means the defaults
+	int EnableRealtimeHaptics(const HLVR_RealtimeHapticsOptions* options);
+	int DisableRealtimeHaptics();
+	int GetRealtimeHapticsStats(HLVR_RealtimeHapticsStats* outStats) const;
+
 	int GetOrientation(uint32_t region, HLVR_Quaternion* outOrientation);
 	int GetCompass(uint32_t region, HLVR_Vector3f* outCompass);
 	int GetGravity(uint32_t region, HLVR_Vector3f* outGravity);
+	int GetAllTracking(HLVR_TrackingSample* outSamples, uint32_t capacity, uint32_t* outCount, uint64_t* inOutSequence);
+	int GetTrackingTime(uint64_t* outMicroseconds) const;
+	int GetOrientationAt(uint32_t region, uint64_t timestampMicroseconds, HLVR_Quaternion* outOrientation);
+	int SubscribeTracking(HLVR_TrackingCallback callback, void* userData);
+	int UnsubscribeTracking();
 private:
 	IoService m_ioService;
 	HLVR_TrackingUpdate m_cachedTrackingUpdate;
 	uint32_t m_currentHandleId;
 	bool m_isHapticsSystemPlaying;
 	ClientMessenger m_messenger;
+	TrackingNotifier m_trackingNotifier;
+	DeviceRegistry m_deviceRegistry;
 
 	EffectPlayer m_player;
-
-	boost::posix_time::milliseconds m_hapticsExecutionInterval;
-	void executeTimestep(std::chrono::milliseconds dt);
-
-	ScheduledEvent m_hapticsTimestep;
-
-	std::chrono::time_point<std::chrono::steady_clock> m_lastHapticsTimestep;
+	EffectCache m_effectCache;
 
 	boost::shared_ptr<MyTestLog> m_log;
 
-	std::vector<std::unique_ptr<HiddenIterator<HLVR_DeviceInfo>>> m_deviceSnapshots;
-	std::vector<std::unique_ptr<HiddenIterator<HLVR_NodeInfo>>> m_nodeSnapshots;
+	//Games may enumerate from any thread
+	std::mutex m_iteratorLock;
+	IteratorPool<HLVR_DeviceInfo> m_deviceIterators;
+	IteratorPool<HLVR_NodeInfo> m_nodeIterators;
 
 	void setupUserFacingLogSink();
 
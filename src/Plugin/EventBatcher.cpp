@@ -0,0 +1,57 @@
+#include "stdafx.h"
+#include "EventBatcher.h"
+
+
+EventBatcher::EventBatcher(std::size_t maxFrameBytes, Push push)
+	: m_frame(maxFrameBytes)
+	, m_maxFrameBytes(maxFrameBytes)
+	, m_push(std::move(push))
+	, m_batchOpen(false)
+{
+}
+
+void EventBatcher::Write(const google::protobuf::MessageLite& event)
+{
+	m_frame.AppendField(events_field, event);
+	pushIfDue();
+}
+
+void EventBatcher::WriteEncoded(EncodedBytes head, EncodedBytes tail)
+{
+	m_frame.AppendEncodedField(events_field, head, tail);
+	pushIfDue();
+}
+
+void EventBatcher::BeginBatch()
+{
+	m_batchOpen = true;
+}
+
+void EventBatcher::EndBatch()
+{
+	m_batchOpen = false;
+	push();
+}
+
+void EventBatcher::Clear()
+{
+	m_frame.Clear();
+}
+
+void EventBatcher::pushIfDue()
+{
+	//Outside of a batch, an event is sent as a frame of one so that everything goes through the same queue, in order
+	if (!m_batchOpen || m_frame.size() >= m_maxFrameBytes) {
+		push();
+	}
+}
+
+void EventBatcher::push()
+{
+	if (m_frame.empty()) {
+		return;
+	}
+
+	m_push(m_frame.data(), m_frame.size());
+	m_frame.Clear();
+}
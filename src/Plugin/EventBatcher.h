@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SerializationBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+//Collects events into frames for the service's batched haptics queue. Each frame is the wire encoding of a message 
+//containing 'repeated HighLevelEvent events = 1', so the service can unpack it with a single parse.
+//
+//While a batch is open, written events are collected and pushed as a single frame by EndBatch, or sooner if the frame
+//grows past its maximum size. Outside of a batch, each event is pushed as a frame of one.
+//This class is not thread safe; synchronization must happen at a higher level
+class EventBatcher {
+public:
+	//Field number of the repeated HighLevelEvent in a frame
+	static const uint32_t events_field = 1;
+
+	//Called with each finished frame. The bytes are only valid for the duration of the call.
+	using Push = std::function<void(const char* data, std::size_t size)>;
+
+	EventBatcher(std::size_t maxFrameBytes, Push push);
+
+	void Write(const google::protobuf::MessageLite& event);
+	//Writes an event which was encoded ahead of time, as two pieces which together make up the message
+	void WriteEncoded(EncodedBytes head, EncodedBytes tail);
+
+	void BeginBatch();
+	void EndBatch();
+
+	//Discards anything not yet pushed
+	void Clear();
+
+private:
+	SerializationBuffer m_frame;
+	std::size_t m_maxFrameBytes;
+	Push m_push;
+	bool m_batchOpen;
+
+	void pushIfDue();
+	void push();
+};
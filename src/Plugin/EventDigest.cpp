@@ -0,0 +1,126 @@
+#include "stdafx.h"
+#include "EventDigest.h"
+
+#include <cstring>
+
+//The body and finalizer of MurmurHash3_x64_128, fed one 64-bit word at a time
+
+static const uint64_t c1 = 0x87c37b91114253d5ULL;
+static const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+static uint64_t rotl64(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t fmix64(uint64_t k) {
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+static uint64_t wordOf(float value) {
+	uint32_t bits = 0;
+	static_assert(sizeof(bits) == sizeof(value), "Floats should be 32 bits");
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static uint64_t wordOf(int value) {
+	return static_cast<uint32_t>(value);
+}
+
+static uint64_t wordOf(uint32_t value) {
+	return value;
+}
+
+static uint64_t wordOf(uint64_t value) {
+	return value;
+}
+
+template<typename Mix>
+class digest_visitor : public boost::static_visitor<void> {
+public:
+	explicit digest_visitor(Mix mix) : m_mix(mix) {}
+
+	template<typename T>
+	void operator()(const T& value) const {
+		m_mix(wordOf(value));
+	}
+
+	template<typename T>
+	void operator()(const std::vector<T>& values) const {
+		//The length goes first, so that neighbouring arrays can't trade elements without changing the digest
+		m_mix(values.size());
+		for (const T& value : values) {
+			m_mix(wordOf(value));
+		}
+	}
+
+private:
+	Mix m_mix;
+};
+
+template<typename Mix>
+digest_visitor<Mix> make_digest_visitor(Mix mix) {
+	return digest_visitor<Mix>(mix);
+}
+
+EventDigester::EventDigester()
+	: m_h1(0)
+	, m_h2(0)
+	, m_words(0)
+{
+}
+
+void EventDigester::Add(float time, const TypedEvent& event)
+{
+	mix(wordOf(time));
+	mix(static_cast<uint64_t>(event.Type));
+	mix(event.Params.size());
+
+	const auto visitor = make_digest_visitor([this](uint64_t word) { mix(word); });
+	event.Params.ForEach([this, &visitor](const event_param& param) {
+		mix(static_cast<uint64_t>(param.key));
+		mix(static_cast<uint64_t>(param.value.which()));
+		boost::apply_visitor(visitor, param.value);
+	});
+}
+
+EventDigest EventDigester::Digest() const
+{
+	uint64_t h1 = m_h1 ^ (m_words * 8);
+	uint64_t h2 = m_h2 ^ (m_words * 8);
+
+	h1 += h2;
+	h2 += h1;
+	h1 = fmix64(h1);
+	h2 = fmix64(h2);
+	h1 += h2;
+	h2 += h1;
+
+	return EventDigest{ h1, h2 };
+}
+
+void EventDigester::Clear()
+{
+	m_h1 = 0;
+	m_h2 = 0;
+	m_words = 0;
+}
+
+//Words take turns at being each half of a Murmur block, so nothing needs buffering into pairs
+void EventDigester::mix(uint64_t word)
+{
+	uint64_t k1 = (m_words % 2 == 0) ? word : 0;
+	uint64_t k2 = (m_words % 2 == 0) ? 0 : word;
+	m_words++;
+
+	k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; m_h1 ^= k1;
+	m_h1 = rotl64(m_h1, 27); m_h1 += m_h2; m_h1 = m_h1 * 5 + 0x52dce729;
+
+	k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; m_h2 ^= k2;
+	m_h2 = rotl64(m_h2, 31); m_h2 += m_h1; m_h2 = m_h2 * 5 + 0x38495ab5;
+}
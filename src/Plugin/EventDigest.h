@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ParameterizedEvent.h"
+
+#include <cstdint>
+
+//A 128-bit fingerprint of a timeline's events, used to recognize a timeline without keeping or comparing its events.
+//Two different timelines getting the same digest by accident is about as likely as a random 128-bit collision.
+//It is not meant to stand up to someone crafting collisions on purpose.
+struct EventDigest {
+	uint64_t High;
+	uint64_t Low;
+
+	bool operator==(const EventDigest& other) const { return High == other.High && Low == other.Low; }
+	bool operator!=(const EventDigest& other) const { return !(*this == other); }
+};
+
+//Builds an EventDigest one event at a time, so that a timeline can keep its digest up to date as events are added
+//instead of hashing them all again when it is transmitted. The digest depends on the order of the events.
+class EventDigester {
+public:
+	EventDigester();
+
+	void Add(float time, const TypedEvent& event);
+
+	EventDigest Digest() const;
+
+	void Clear();
+
+private:
+	uint64_t m_h1;
+	uint64_t m_h2;
+	uint64_t m_words;
+
+	void mix(uint64_t word);
+};
@@ -6,6 +6,7 @@
 
 EventList::EventList()
 	: m_events()
+	, m_digest()
 	, m_eventLock()
 {
 	m_events.reserve(1);
@@ -14,14 +15,24 @@ EventList::EventList()
 int EventList::AddEvent(TimeOffset<TypedEvent> event)
 {	
 	std::lock_guard<std::mutex> guard(m_eventLock);
+	m_digest.Add(event.Time, event.Data);
 	m_events.push_back(std::move(event));
 	return HLVR_Ok;
 }
 
-std::vector<TimeOffset<TypedEvent>> EventList::events() const
+std::vector<TimeOffset<TypedEvent>> EventList::TakeEvents()
 {
+	std::vector<TimeOffset<TypedEvent>> events;
 	std::lock_guard<std::mutex> guard(m_eventLock);
-	return m_events;
+	events.swap(m_events);
+	m_digest.Clear();
+	return events;
+}
+
+std::size_t EventList::size() const
+{
+	std::lock_guard<std::mutex> guard(m_eventLock);
+	return m_events.size();
 }
 
 bool EventList::empty() const
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ParameterizedEvent.h"
+#include "EventDigest.h"
 
 #include <mutex>
 
@@ -16,11 +17,28 @@ public:
 	
 	EventList();
 	int AddEvent(TimeOffset<TypedEvent> data);
-	std::vector<TimeOffset<TypedEvent>> events() const;
+
+	//Calls fn(events, digest) with the events in place, while holding the lock. The digest is kept up to date
+	//as events are added, so it costs nothing here.
+	template<typename Fn>
+	void WithEvents(Fn&& fn) const;
+
+	//Moves all of the events out, leaving the list empty
+	std::vector<TimeOffset<TypedEvent>> TakeEvents();
+
+	std::size_t size() const;
 	bool empty() const;
 private:
 	std::vector<TimeOffset<TypedEvent>> m_events;
+	EventDigester m_digest;
 	mutable std::mutex m_eventLock;
 
 };
 
+template<typename Fn>
+inline void EventList::WithEvents(Fn&& fn) const
+{
+	std::lock_guard<std::mutex> guard(m_eventLock);
+	fn(static_cast<const std::vector<TimeOffset<TypedEvent>>&>(m_events), m_digest.Digest());
+}
+
@@ -1,19 +1,15 @@
 #include "stdafx.h"
 #include "AnalogAudio.h"
-#pragma warning(push)
-#pragma warning(disable : 4267)
-#include "HighLevelEvent.pb.h"
-#pragma warning(pop)
+#include "EventStore.h"
 
 
 BeginAnalogAudio::BeginAnalogAudio(float time) : PlayableEvent(time)
 {
 }
 
-void BeginAnalogAudio::doSerialize(NullSpaceIPC::HighLevelEvent & event) const
+void BeginAnalogAudio::doCompact(CompactEvent& compacted, EventStore&) const
 {
-	auto locational = event.mutable_locational_event();
-	auto beginAnalog = locational->mutable_begin_analog_audio();
+	compacted.kind = EventKind::BeginAnalogAudio;
 }
 
 void BeginAnalogAudio::doParse(const ParameterizedEvent & event)
@@ -24,10 +20,9 @@ EndAnalogAudio::EndAnalogAudio(float time) : PlayableEvent(time)
 {
 }
 
-void EndAnalogAudio::doSerialize(NullSpaceIPC::HighLevelEvent & event) const
+void EndAnalogAudio::doCompact(CompactEvent& compacted, EventStore&) const
 {
-	auto locational = event.mutable_locational_event();
-	auto end = locational->mutable_end_analog_audio();
+	compacted.kind = EventKind::EndAnalogAudio;
 }
 
 void EndAnalogAudio::doParse(const ParameterizedEvent &)
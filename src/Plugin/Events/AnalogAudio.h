@@ -7,7 +7,7 @@ public:
 	BeginAnalogAudio(float time);
 	float duration() const override { return 0.0f; }
 private:
-	void doSerialize(NullSpaceIPC::HighLevelEvent& event) const override;
+	void doCompact(CompactEvent& compacted, EventStore& store) const override;
 	void doParse(const ParameterizedEvent& event) override;
 	bool isEqual(const PlayableEvent& other) const override { return true; }
 };
@@ -18,7 +18,7 @@ public:
 	EndAnalogAudio(float time);
 	float duration() const override { return 0.0f; }
 private:
-	void doSerialize(NullSpaceIPC::HighLevelEvent& event) const override;
+	void doCompact(CompactEvent& compacted, EventStore& store) const override;
 	void doParse(const ParameterizedEvent&) override;
 	bool isEqual(const PlayableEvent& other) const override { return true; }
 
@@ -1,9 +1,6 @@
 #include "stdafx.h"
 #include "BufferedHaptic.h"
-#pragma warning(push)
-#pragma warning(disable : 4267)
-#include "HighLevelEvent.pb.h"
-#pragma warning(pop)
+#include "EventStore.h"
 BufferedHaptic::BufferedHaptic(float time) : PlayableEvent(time), m_samples(), m_frequency(1.0)
 {
 }
@@ -21,23 +18,25 @@ std::vector<Validator> BufferedHaptic::makeValidators() const
 	};
 }
 
-void BufferedHaptic::doSerialize(NullSpaceIPC::HighLevelEvent& event) const
+void BufferedHaptic::doCompact(CompactEvent& compacted, EventStore& store) const
 {
-	auto loc = event.mutable_locational_event();
-	auto buf = loc->mutable_buffered_haptic();
-	buf->set_frequency(m_frequency);
-	
-	auto samples = buf->mutable_samples();
-	
-	for (const float s : m_samples) {
-		samples->Add(s);
-	}
+	compacted.kind = EventKind::BufferedHaptic;
+	compacted.payload.buffered.frequency = m_frequency;
+	compacted.payload.buffered.sampleOffset = store.AddSamples(m_samples);
+	compacted.payload.buffered.sampleCount = static_cast<uint32_t>(m_samples.size());
 }
 
 void BufferedHaptic::doParse(const ParameterizedEvent & ev)
 {
 	m_frequency = ev.GetOr(HLVR_EventKey_BufferedHaptic_Frequency_Float, 60.0f);
-	m_samples = ev.GetOr(HLVR_EventKey_BufferedHaptic_Samples_Floats, std::vector<float>{});
+	ArrayView<float> samples = ev.GetArray<float>(HLVR_EventKey_BufferedHaptic_Samples_Floats);
+	m_samples.assign(samples.begin(), samples.end());
+}
+
+void BufferedHaptic::doConsume(ParameterizedEvent & ev)
+{
+	m_frequency = ev.GetOr(HLVR_EventKey_BufferedHaptic_Frequency_Float, 60.0f);
+	ev.Take(HLVR_EventKey_BufferedHaptic_Samples_Floats, &m_samples);
 }
 
 bool BufferedHaptic::isEqual(const PlayableEvent & other) const
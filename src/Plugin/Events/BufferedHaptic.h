@@ -15,9 +15,10 @@ private:
 	std::vector<Validator> makeValidators() const override;
 
 
-	void doSerialize(NullSpaceIPC::HighLevelEvent& event) const override;
+	void doCompact(CompactEvent& compacted, EventStore& store) const override;
 
 	void doParse(const ParameterizedEvent&) override;
+	void doConsume(ParameterizedEvent&) override;
 
 
 	bool isEqual(const PlayableEvent& other) const override;
@@ -3,6 +3,7 @@
 #include "Locator.h"
 
 #include "validators.h"
+#include "EventStore.h"
 #pragma warning(push)
 #pragma warning(disable : 4267)
 #include "HighLevelEvent.pb.h"
@@ -63,16 +64,12 @@ bool DiscreteHapticEvent::isEqual(const PlayableEvent& other) const
 		&& m_duration == ev.m_duration;
 }
 
-void DiscreteHapticEvent::doSerialize(NullSpaceIPC::HighLevelEvent& event) const
+void DiscreteHapticEvent::doCompact(CompactEvent& compacted, EventStore&) const
 {
-	using namespace NullSpaceIPC;
-	LocationalEvent* location = event.mutable_locational_event();
-	SimpleHaptic* simple = location->mutable_simple_haptic();
-	simple->set_repetitions(m_duration);
-	simple->set_effect(m_requestedEffectFamily);
-	simple->set_strength(m_strength);
-
-	
+	compacted.kind = EventKind::DiscreteHaptic;
+	compacted.payload.discrete.repetitions = m_duration;
+	compacted.payload.discrete.waveform = m_requestedEffectFamily;
+	compacted.payload.discrete.strength = m_strength;
 }
 
 float DiscreteHapticEvent::strength() const
@@ -19,7 +19,7 @@ public:
 
 private:
 	void doParse(const ParameterizedEvent&) override;
-	void doSerialize(NullSpaceIPC::HighLevelEvent& event) const override;
+	void doCompact(CompactEvent& compacted, EventStore& store) const override;
 	std::vector<Validator> makeValidators() const override;
 
 	static constexpr HLVR_EventType descriptor = HLVR_EventType::HLVR_EventType_DiscreteHaptic;
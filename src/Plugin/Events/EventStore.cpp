@@ -0,0 +1,216 @@
+#include "stdafx.h"
+#include "EventStore.h"
+
+#pragma warning(push)
+#pragma warning(disable : 4267)
+#include "HighLevelEvent.pb.h"
+#pragma warning(pop)
+
+#include <string>
+#include <unordered_map>
+
+class compact_target_visitor : public boost::static_visitor<void> {
+public:
+	compact_target_visitor(CompactEvent* event, std::vector<uint32_t>* pool) : m_event(event), m_pool(pool) {}
+	void operator()(const TargetRegions& target) {
+		m_event->targetKind = TargetKind::Regions;
+		m_event->regions = target.mask;
+		append(target.subregions);
+	}
+	void operator()(const TargetNodes& target) {
+		m_event->targetKind = TargetKind::Nodes;
+		append(target.nodes);
+	}
+private:
+	CompactEvent* m_event;
+	std::vector<uint32_t>* m_pool;
+
+	void append(const std::vector<uint32_t>& ids) {
+		m_event->targetOffset = static_cast<uint32_t>(m_pool->size());
+		m_event->targetCount = static_cast<uint32_t>(ids.size());
+		m_pool->insert(m_pool->end(), ids.begin(), ids.end());
+	}
+};
+
+EventStore::EventStore()
+	: m_events()
+	, m_targets()
+	, m_samples()
+	, m_encoded()
+	, m_encodedSpans()
+{
+}
+
+void EventStore::Reserve(std::size_t numEvents)
+{
+	m_events.reserve(numEvents);
+}
+
+CompactEvent& EventStore::Append(float time, float duration, const Target& target)
+{
+	CompactEvent event = {};
+	event.time = time;
+	event.duration = duration;
+
+	compact_target_visitor compactTarget(&event, &m_targets);
+	boost::apply_visitor(compactTarget, target);
+
+	m_events.push_back(event);
+	return m_events.back();
+}
+
+uint32_t EventStore::AddSamples(const std::vector<float>& samples)
+{
+	uint32_t offset = static_cast<uint32_t>(m_samples.size());
+	m_samples.insert(m_samples.end(), samples.begin(), samples.end());
+	return offset;
+}
+
+void EventStore::Serialize(std::size_t index, NullSpaceIPC::HighLevelEvent& event) const
+{
+	using namespace NullSpaceIPC;
+
+	if (IsEncoded()) {
+		EncodedBytes bytes = Encoded(index);
+		HighLevelEvent encoded;
+		encoded.ParseFromArray(bytes.data, static_cast<int>(bytes.size));
+		event.MergeFrom(encoded);
+		return;
+	}
+
+	const CompactEvent& compact = m_events[index];
+	LocationalEvent* locational = event.mutable_locational_event();
+	Location* location = locational->mutable_location();
+
+	switch (compact.targetKind) {
+	case TargetKind::Regions: {
+		auto regions = location->mutable_regions();
+		forEachRegion(compact.regions, [regions](uint32_t region) { regions->add_regions(region); });
+		for (uint32_t i = 0; i < compact.targetCount; i++) {
+			regions->add_regions(m_targets[compact.targetOffset + i]);
+		}
+		break;
+	}
+	case TargetKind::Nodes: {
+		auto nodes = location->mutable_nodes();
+		for (uint32_t i = 0; i < compact.targetCount; i++) {
+			nodes->add_nodes(m_targets[compact.targetOffset + i]);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	switch (compact.kind) {
+	case EventKind::DiscreteHaptic: {
+		SimpleHaptic* simple = locational->mutable_simple_haptic();
+		simple->set_repetitions(compact.payload.discrete.repetitions);
+		simple->set_effect(compact.payload.discrete.waveform);
+		simple->set_strength(compact.payload.discrete.strength);
+		break;
+	}
+	case EventKind::BufferedHaptic: {
+		auto buffered = locational->mutable_buffered_haptic();
+		buffered->set_frequency(compact.payload.buffered.frequency);
+
+		auto samples = buffered->mutable_samples();
+		const float* first = m_samples.data() + compact.payload.buffered.sampleOffset;
+		samples->Reserve(compact.payload.buffered.sampleCount);
+		for (uint32_t i = 0; i < compact.payload.buffered.sampleCount; i++) {
+			samples->AddAlreadyReserved(first[i]);
+		}
+		break;
+	}
+	case EventKind::BeginAnalogAudio:
+		locational->mutable_begin_analog_audio();
+		break;
+	case EventKind::EndAnalogAudio:
+		locational->mutable_end_analog_audio();
+		break;
+	default:
+		break;
+	}
+}
+
+void EventStore::Encode()
+{
+	if (IsEncoded()) {
+		return;
+	}
+
+	std::vector<EncodedSpan> encodedSpans;
+	encodedSpans.reserve(m_events.size());
+
+	//Only needed while encoding, to find events which encode the same as an earlier one
+	std::unordered_map<std::string, EncodedSpan> spansByEncoding;
+	std::string encoding;
+
+	for (std::size_t i = 0; i < m_events.size(); i++) {
+		NullSpaceIPC::HighLevelEvent event;
+		Serialize(i, event);
+		event.SerializeToString(&encoding);
+
+		EncodedSpan span = { static_cast<uint32_t>(m_encoded.size()), static_cast<uint32_t>(encoding.size()) };
+		auto inserted = spansByEncoding.emplace(encoding, span);
+		if (inserted.second) {
+			m_encoded.insert(m_encoded.end(), encoding.begin(), encoding.end());
+		}
+		else {
+			span = inserted.first->second;
+		}
+
+		encodedSpans.push_back(span);
+	}
+	m_encoded.shrink_to_fit();
+	m_encodedSpans = std::move(encodedSpans);
+
+	//Otherwise the store would hold every event twice. Only AppendRegions still reads the pools, and only for regions.
+	std::vector<uint32_t> regionTargets;
+	for (CompactEvent& event : m_events) {
+		if (event.targetKind == TargetKind::Regions) {
+			const uint32_t offset = static_cast<uint32_t>(regionTargets.size());
+			regionTargets.insert(regionTargets.end(),
+				m_targets.begin() + event.targetOffset,
+				m_targets.begin() + event.targetOffset + event.targetCount);
+			event.targetOffset = offset;
+		}
+		else {
+			event.targetOffset = 0;
+		}
+	}
+	regionTargets.shrink_to_fit();
+	m_targets = std::move(regionTargets);
+	std::vector<float>().swap(m_samples);
+}
+
+EncodedBytes EventStore::Encoded(std::size_t index) const
+{
+	assert(index < m_encodedSpans.size());
+	const EncodedSpan& span = m_encodedSpans[index];
+	return EncodedBytes{ m_encoded.data() + span.offset, span.size };
+}
+
+void EventStore::AppendRegions(std::size_t index, std::vector<uint32_t>* outRegions) const
+{
+	const CompactEvent& compact = m_events[index];
+	switch (compact.targetKind) {
+	case TargetKind::Regions:
+		forEachRegion(compact.regions, [outRegions](uint32_t region) { outRegions->push_back(region); });
+		outRegions->insert(outRegions->end(), 
+			m_targets.begin() + compact.targetOffset, 
+			m_targets.begin() + compact.targetOffset + compact.targetCount);
+		break;
+	default:
+		break;
+	}
+}
+
+std::size_t EventStore::MemoryUsage() const
+{
+	return m_events.capacity() * sizeof(CompactEvent)
+		+ m_targets.capacity() * sizeof(uint32_t)
+		+ m_samples.capacity() * sizeof(float)
+		+ m_encoded.capacity()
+		+ m_encodedSpans.capacity() * sizeof(EncodedSpan);
+}
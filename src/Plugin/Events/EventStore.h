@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RegionMask.h"
+#include "target.h"
+#include "SerializationBuffer.h"
+
+namespace NullSpaceIPC {
+	class HighLevelEvent;
+}
+
+enum class EventKind : uint8_t {
+	DiscreteHaptic,
+	BufferedHaptic,
+	BeginAnalogAudio,
+	EndAnalogAudio
+};
+
+enum class TargetKind : uint8_t {
+	//Target is the RegionMask, plus a run of sub-region ids in the store's target pool
+	Regions,
+	//Target is a run of node ids in the store's target pool
+	Nodes
+};
+
+struct DiscreteHapticPayload {
+	float strength;
+	uint32_t waveform;
+	uint32_t repetitions;
+};
+
+struct BufferedHapticPayload {
+	float frequency;
+	uint32_t sampleOffset;
+	uint32_t sampleCount;
+};
+
+//One timeline event, laid out flat with no heap allocations of its own. Anything variable-length lives in the pools 
+//of the EventStore which owns it, referenced by offset.
+struct CompactEvent {
+	RegionMask regions;
+	float time;
+	float duration;
+	uint32_t targetOffset;
+	uint32_t targetCount;
+	union Payload {
+		DiscreteHapticPayload discrete;
+		BufferedHapticPayload buffered;
+	} payload;
+	EventKind kind;
+	TargetKind targetKind;
+};
+
+//The events of an effect, held contiguously: one CompactEvent per event, plus shared pools for sub-regions, 
+//nodes and buffered haptic samples.
+//Events are produced by PlayableEvent::compact, which is the only way in.
+//This class is not thread safe; synchronization must happen at a higher level
+class EventStore {
+public:
+	EventStore();
+
+	void Reserve(std::size_t numEvents);
+
+	//Appends an event with the given timing and target. The caller fills in kind and payload.
+	//The reference is valid until the next call to Append.
+	CompactEvent& Append(float time, float duration, const Target& target);
+
+	//Copies samples into the pool, and returns the offset of the first one
+	uint32_t AddSamples(const std::vector<float>& samples);
+
+	//Fills out the locational part of a HighLevelEvent for the given event. Once the store is encoded, this parses
+	//the event's encoded bytes, so it's slower than before, but gives the same result.
+	void Serialize(std::size_t index, NullSpaceIPC::HighLevelEvent& event) const;
+
+	//Precomputes the wire encoding of each event: a HighLevelEvent as filled out by Serialize, with no parent id.
+	//Call once every event has been appended. Afterwards, sending an event is just a copy of its bytes.
+	//The samples and node ids are released, since the encoding holds them, so an event's sampleOffset and 
+	//its targetOffset for nodes no longer mean anything. Region targets are kept, for AppendRegions.
+	void Encode();
+	bool IsEncoded() const { return !m_encodedSpans.empty(); }
+
+	//The bytes computed by Encode for the given event
+	EncodedBytes Encoded(std::size_t index) const;
+
+	//Appends the regions targeted by the given event, if it targets regions rather than nodes. Works before and
+	//after encoding.
+	void AppendRegions(std::size_t index, std::vector<uint32_t>* outRegions) const;
+
+	const CompactEvent& operator[](std::size_t index) const { return m_events[index]; }
+	std::size_t size() const { return m_events.size(); }
+	bool empty() const { return m_events.empty(); }
+
+	//Approximate heap footprint of the store
+	std::size_t MemoryUsage() const;
+private:
+	std::vector<CompactEvent> m_events;
+	std::vector<uint32_t> m_targets;
+	std::vector<float> m_samples;
+
+	struct EncodedSpan {
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	//Event i is encoded in m_encoded[m_encodedSpans[i].offset, + size). Events with the same encoding, such as a pulse
+	//repeated through a timeline, share one copy of it.
+	std::vector<char> m_encoded;
+	std::vector<EncodedSpan> m_encodedSpans;
+};
@@ -10,6 +10,7 @@
 #include "DiscreteHapticEvent.h"
 #include "ContinuousHaptic.h"
 #include "BufferedHaptic.h"
+#include "EventStore.h"
 #pragma warning(push)
 #pragma warning(disable : 4267)
 #include "HighLevelEvent.pb.h"
@@ -19,48 +20,32 @@
 
 
 
-class serialize_target_visitor : public boost::static_visitor<void> {
-
-public:
-	serialize_target_visitor(NullSpaceIPC::Location* location) : m_location(location) {
-
-	}
-	void operator()(const TargetRegions& regions) {
-		auto mut_regions = m_location->mutable_regions();
-		for (auto region : regions.regions) {
-			mut_regions->add_regions(region);
-		}
-	}
-	void operator()(const TargetNodes& nodes) {
-		auto mut_nodes = m_location->mutable_nodes();
-		for (auto node : nodes.nodes) {
-			mut_nodes->add_nodes(node);
-		}
-	}
-	
-private:
-	NullSpaceIPC::Location* m_location;
-};
-
+void PlayableEvent::parse(const ParameterizedEvent & e)
+{
+	parseTarget(e);
+	doParse(e); 
+}
 
+void PlayableEvent::parse(ParameterizedEvent && e)
+{
+	parseTarget(e);
+	doConsume(e);
+}
 
-void PlayableEvent::parse(const ParameterizedEvent & e)
+void PlayableEvent::parseTarget(const ParameterizedEvent & e)
 {
-	TargetRegions regions;
 	TargetNodes nodes;
 
 
-	if (e.TryGet(HLVR_EventKey_Target_Regions_UInt32s, &regions.regions)) {
-		m_target = regions;
+	if (const auto* regions = e.Find<std::vector<uint32_t>>(HLVR_EventKey_Target_Regions_UInt32s)) {
+		m_target = makeTargetRegions(*regions);
 	}
 	else if (e.TryGet(HLVR_EventKey_Target_Nodes_UInt32s, &nodes.nodes)) {
 		m_target = nodes;
 	}
 	else {
-		m_target = TargetRegions{ {hlvr_region_body} };
+		m_target = TargetRegions{ regionBit(hlvr_region_body), {} };
 	}
-
-	doParse(e); 
 }
 
 bool PlayableEvent::operator<(const PlayableEvent & rhs) const
@@ -70,12 +55,16 @@ bool PlayableEvent::operator<(const PlayableEvent & rhs) const
 
 void PlayableEvent::serialize(NullSpaceIPC::HighLevelEvent & event) const
 {
-	NullSpaceIPC::LocationalEvent* location = event.mutable_locational_event();
+	//There's exactly one encoding of each event type, which works from the compact form
+	EventStore store;
+	compact(store);
+	store.Serialize(0, event);
+}
 
-	serialize_target_visitor extractor(location->mutable_location());
-	boost::apply_visitor(extractor, m_target);
-	
-	doSerialize(event);
+void PlayableEvent::compact(EventStore& store) const
+{
+	CompactEvent& compacted = store.Append(m_time, duration(), m_target);
+	doCompact(compacted, store);
 }
 
 std::unique_ptr<PlayableEvent>
@@ -148,6 +137,11 @@ float PlayableEvent::time() const
 	return m_time; 
 }
 
+const Target& PlayableEvent::target() const
+{
+	return m_target;
+}
+
 void PlayableEvent::debug_parse(const ParameterizedEvent & event, HLVR_Event_ValidationResult * result) const
 {
 	*result = { 0 };
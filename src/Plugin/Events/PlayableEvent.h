@@ -7,6 +7,8 @@
 #include "target.h"
 
 class ParameterizedEvent;
+class EventStore;
+struct CompactEvent;
 
 namespace NullSpaceIPC {
 	class HighLevelEvent;
@@ -26,14 +28,23 @@ public:
 	//Return time offset of the event in fractional seconds
 	float time() const;
 
+	//Return the regions or nodes the event should play on
+	const Target& target() const;
+
 	//Perform a parse of the given ParameterizedEvent, but don't actually create a real event - just throw results in 'result'
 	void debug_parse(const ParameterizedEvent& event, HLVR_Event_ValidationResult* result) const;
 
 	//Perform a true parse of the ParameterizedEvent
 	void parse(const ParameterizedEvent& e);
 
+	//Same as parse, but large values may be moved out of the event instead of copied
+	void parse(ParameterizedEvent&& e);
+
 	//Serialize the event into our transport protocol message
 	void serialize(NullSpaceIPC::HighLevelEvent& event) const;
+
+	//Append the event to the store in its flat form, which is what effects keep and play back
+	void compact(EventStore& store) const;
 	
 	//Compare events based on time offset
 	bool operator<(const PlayableEvent& rhs) const;
@@ -53,8 +64,10 @@ private:
 	Target m_target;
 	
 	virtual std::vector<Validator> makeValidators() const { return std::vector<Validator>{}; }
-	virtual void doSerialize(NullSpaceIPC::HighLevelEvent& event) const = 0;
+	virtual void doCompact(CompactEvent& compacted, EventStore& store) const = 0;
 	virtual void doParse(const ParameterizedEvent&) = 0;
+	virtual void doConsume(ParameterizedEvent& e) { doParse(e); }
+	void parseTarget(const ParameterizedEvent& e);
 	virtual bool isEqual(const PlayableEvent& other) const = 0;
 };
 
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "HLVR.h"
+
+//The regions named in HLVR.h, packed into the bits of a single integer. Bit i stands for well_known_regions[i].
+//Arbitrary sub-regions (anything else inside a HLVR_SUBREGION_BLOCK) can't be represented, and need to be kept as a list.
+using RegionMask = uint64_t;
+
+const uint32_t well_known_regions[] = {
+	hlvr_region_UNKNOWN,
+	hlvr_region_body,
+	hlvr_region_torso,
+	hlvr_region_torso_front,
+	hlvr_region_middle_sternum,
+	hlvr_region_chest_left,
+	hlvr_region_chest_right,
+	hlvr_region_upper_ab_left,
+	hlvr_region_middle_ab_left,
+	hlvr_region_lower_ab_left,
+	hlvr_region_upper_ab_right,
+	hlvr_region_middle_ab_right,
+	hlvr_region_lower_ab_right,
+	hlvr_region_torso_back,
+	hlvr_region_torso_left,
+	hlvr_region_torso_right,
+	hlvr_region_upper_back_left,
+	hlvr_region_upper_back_right,
+	hlvr_region_upper_arm_left,
+	hlvr_region_lower_arm_left,
+	hlvr_region_upper_arm_right,
+	hlvr_region_lower_arm_right,
+	hlvr_region_shoulder_left,
+	hlvr_region_shoulder_right,
+	hlvr_region_upper_leg_left,
+	hlvr_region_lower_leg_left,
+	hlvr_region_upper_leg_right,
+	hlvr_region_lower_leg_right,
+	hlvr_region_head,
+	hlvr_region_palm_left,
+	hlvr_region_palm_right
+};
+
+const std::size_t num_well_known_regions = sizeof(well_known_regions) / sizeof(well_known_regions[0]);
+static_assert(num_well_known_regions <= 64, "Well known regions must fit in a RegionMask");
+
+//Returns the position of the region in well_known_regions, or num_well_known_regions if the region isn't well known
+inline std::size_t regionIndex(uint32_t region) {
+	//Every well known region except the sternum sits at the start of its block
+	if (region == hlvr_region_middle_sternum) {
+		return 4;
+	}
+
+	if (region % HLVR_SUBREGION_BLOCK != 0) {
+		return num_well_known_regions;
+	}
+
+	const uint32_t block = region / HLVR_SUBREGION_BLOCK;
+	if (block > hlvr_region_palm_right / HLVR_SUBREGION_BLOCK) {
+		return num_well_known_regions;
+	}
+
+	//Blocks after the torso front are shifted up by one to make room for the sternum
+	return block <= 3 ? block : block + 1;
+}
+
+//Returns the bit for the region, or 0 if the region isn't well known
+inline RegionMask regionBit(uint32_t region) {
+	const std::size_t index = regionIndex(region);
+	return index < num_well_known_regions ? RegionMask(1) << index : 0;
+}
+
+//Calls fn(region) for each region in the mask, in the order of well_known_regions
+template<typename Fn>
+void forEachRegion(RegionMask mask, Fn&& fn) {
+	for (std::size_t bit = 0; mask != 0 && bit < num_well_known_regions; bit++) {
+		if (mask & (RegionMask(1) << bit)) {
+			fn(well_known_regions[bit]);
+			mask &= ~(RegionMask(1) << bit);
+		}
+	}
+}
@@ -1,16 +1,55 @@
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 #include <boost/variant.hpp>
+#include "RegionMask.h"
 
+//A set of regions. The regions named in HLVR.h, which are almost always what gets targeted, are a bitmask;
+//only arbitrary sub-regions fall back to a list.
 struct TargetRegions {
-	std::vector<uint32_t> regions;
+	RegionMask mask;
+	//Sorted, without duplicates
+	std::vector<uint32_t> subregions;
 };
 
+inline TargetRegions makeTargetRegions(const std::vector<uint32_t>& regions) {
+	TargetRegions target = { 0, {} };
+	for (uint32_t region : regions) {
+		RegionMask bit = regionBit(region);
+		if (bit != 0) {
+			target.mask |= bit;
+		}
+		else {
+			target.subregions.push_back(region);
+		}
+	}
+
+	if (!target.subregions.empty()) {
+		std::sort(target.subregions.begin(), target.subregions.end());
+		target.subregions.erase(
+			std::unique(target.subregions.begin(), target.subregions.end()), 
+			target.subregions.end());
+	}
+
+	return target;
+}
+
+//Calls fn(region) for each targeted region: the well known ones first, then the sub-regions
+template<typename Fn>
+void forEachRegion(const TargetRegions& target, Fn&& fn) {
+	forEachRegion(target.mask, fn);
+	for (uint32_t region : target.subregions) {
+		fn(region);
+	}
+}
+
+//Constant time unless either side has sub-regions
 inline bool operator==(const TargetRegions& lhs, const TargetRegions& rhs) {
-	return lhs.regions == rhs.regions;
+	return lhs.mask == rhs.mask && lhs.subregions == rhs.subregions;
 }
 
+//Node ids are arbitrary, so they stay a list
 struct TargetNodes {
 	std::vector<uint32_t> nodes;
 };
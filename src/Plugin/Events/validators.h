@@ -23,9 +23,8 @@ static const key_req_t key_required;
 
 template<typename T, typename Constraint>
 boost::optional<HLVR_Event_KeyParseError> validate_helper(HLVR_EventKey key, const ParameterizedEvent& event, Constraint&& constraint) {
-	T value;
-	if (event.TryGet(key, &value)) {
-		if (!constraint(value)) {
+	if (const T* value = event.Find<T>(key)) {
+		if (!constraint(*value)) {
 			return HLVR_Event_KeyParseError_InvalidValue;
 		}
 	}
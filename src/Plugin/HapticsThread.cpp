@@ -0,0 +1,81 @@
+#include "stdafx.h"
+#include "HapticsThread.h"
+
+//timeBeginPeriod lives in the multimedia API, which WIN32_LEAN_AND_MEAN leaves out
+#include <mmsystem.h>
+
+
+HapticsThread::HapticsThread(const HapticsThreadOptions& options, Clock::time_point firstDeadline, Tick tick)
+	: m_options(options)
+	, m_status()
+	, m_tick(std::move(tick))
+	, m_shouldQuit(false)
+	, m_raisedTimerResolution(false)
+	, m_thread()
+{
+	//By default Windows wakes sleeping threads every ~15ms, which is coarser than the tick itself.
+	//This is process wide, so it is undone when the thread goes away.
+	m_raisedTimerResolution = (timeBeginPeriod(1) == TIMERR_NOERROR);
+
+	m_thread = std::thread([this, firstDeadline]() { run(firstDeadline); });
+	applyOptions();
+}
+
+HapticsThread::~HapticsThread()
+{
+	m_shouldQuit.store(true);
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+
+	if (m_raisedTimerResolution) {
+		timeEndPeriod(1);
+	}
+}
+
+HapticsThreadStatus HapticsThread::Status() const
+{
+	return m_status;
+}
+
+//Each of these may be refused (by policy, or because the mask names CPUs the process can't use).
+//The thread works either way, just with less precise timing, so failures are only reported.
+void HapticsThread::applyOptions()
+{
+	HANDLE thread = m_thread.native_handle();
+
+	if (m_options.RaisePriority) {
+		m_status.PriorityRaised = SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL) != 0
+			|| SetThreadPriority(thread, THREAD_PRIORITY_HIGHEST) != 0;
+	}
+
+	if (m_options.AffinityMask != 0) {
+		m_status.AffinityApplied = SetThreadAffinityMask(thread, static_cast<DWORD_PTR>(m_options.AffinityMask)) != 0;
+	}
+}
+
+void HapticsThread::run(Clock::time_point firstDeadline)
+{
+	Clock::time_point deadline = firstDeadline;
+	for (;;) {
+		waitUntil(deadline);
+
+		//waitUntil gives up early when the thread is stopped, so the deadline may not have come
+		if (m_shouldQuit.load()) {
+			break;
+		}
+		deadline = m_tick();
+	}
+}
+
+void HapticsThread::waitUntil(Clock::time_point deadline) const
+{
+	const auto untilSpin = deadline - m_options.Spin - Clock::now();
+	if (untilSpin > Clock::duration::zero()) {
+		std::this_thread::sleep_for(untilSpin);
+	}
+
+	while (Clock::now() < deadline && !m_shouldQuit.load(std::memory_order_relaxed)) {
+		std::this_thread::yield();
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+struct HapticsThreadOptions {
+	//Ask for the highest thread priority the OS allows without special rights
+	bool RaisePriority;
+	//CPUs the thread may run on, one bit each. 0 leaves the thread wherever the OS puts it.
+	uint64_t AffinityMask;
+	//How long before each deadline to stop sleeping and start spinning. Sleeps can overshoot by about the
+	//timer resolution, so spinning the last stretch trades some CPU time for precise wakeups.
+	std::chrono::microseconds Spin;
+};
+
+//Which of the requested options the OS actually granted. Anything refused is simply done without.
+struct HapticsThreadStatus {
+	bool PriorityRaised;
+	bool AffinityApplied;
+};
+
+//A thread of its own for the haptics tick, for when asio timer wakeups aren't precise enough.
+//Each tick is waited for by sleeping until shortly before its deadline, then spinning until the deadline itself.
+//The thread starts on construction and is joined on destruction.
+class HapticsThread {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	//Called at each deadline. Returns the deadline of the next tick.
+	using Tick = std::function<Clock::time_point()>;
+
+	HapticsThread(const HapticsThreadOptions& options, Clock::time_point firstDeadline, Tick tick);
+	~HapticsThread();
+
+	HapticsThread(const HapticsThread&) = delete;
+	HapticsThread& operator=(const HapticsThread&) = delete;
+
+	HapticsThreadStatus Status() const;
+
+private:
+	HapticsThreadOptions m_options;
+	HapticsThreadStatus m_status;
+	Tick m_tick;
+	std::atomic<bool> m_shouldQuit;
+	bool m_raisedTimerResolution;
+	std::thread m_thread;
+
+	void run(Clock::time_point firstDeadline);
+	void waitUntil(Clock::time_point deadline) const;
+	void applyOptions();
+};
@@ -2,45 +2,85 @@
 #include "IoService.h"
 
 
-IoService::IoService()
-	: m_running{false}
-	, m_ioLoop{}
+IoService::IoService(std::size_t housekeepingThreads)
+	: m_hapticsIo{}
 	, m_io{}
+	, m_callbackIo{}
+	, m_hapticsWork{}
 	, m_work{}
+	, m_callbackWork{}
+	, m_hapticsLoop{}
+	, m_callbackLoop{}
+	, m_ioLoops{}
 	, m_shouldQuit{false}
 {
-	start();
+	start(std::max<std::size_t>(1, housekeepingThreads));
 }
 
-void IoService::start() {
-	m_running = true;
-	m_ioLoop = std::thread([&]() {
-		while (!m_shouldQuit.load()) {
-			try {
-				m_work = std::make_unique<boost::asio::io_service::work>(m_io);
-				m_io.run(); //wait here for a while
-				m_io.reset(); //someone stopped us? Reset
-			}
-			catch (boost::system::system_error&) {
-				//The io_service couldn't reset?
-				//todo: log this 
-			}
+void IoService::start(std::size_t housekeepingThreads) {
+	//The work objects keep run() from returning when there happens to be nothing queued
+	m_hapticsWork = std::make_unique<boost::asio::io_service::work>(m_hapticsIo);
+	m_work = std::make_unique<boost::asio::io_service::work>(m_io);
+	m_callbackWork = std::make_unique<boost::asio::io_service::work>(m_callbackIo);
+
+	m_hapticsLoop = std::thread([&]() { run(m_hapticsIo); });
+	//A late haptics tick is felt; a late log poll isn't
+	SetThreadPriority(m_hapticsLoop.native_handle(), THREAD_PRIORITY_HIGHEST);
+
+	for (std::size_t i = 0; i < housekeepingThreads; i++) {
+		m_ioLoops.emplace_back([&]() { run(m_io); });
+	}
+
+	m_callbackLoop = std::thread([&]() { run(m_callbackIo); });
+}
+
+void IoService::run(boost::asio::io_service& io)
+{
+	while (!m_shouldQuit.load()) {
+		try {
+			io.run(); //wait here until Shutdown
 		}
-	});
+		catch (boost::system::system_error&) {
+			//A handler threw; other threads may still be running the io_service, so carry on where we left off
+			//todo: log this 
+		}
+	}
 }
 
 void IoService::Shutdown()
 {
 	m_shouldQuit.store(true);
+	m_hapticsWork.reset();
 	m_work.reset();
+	m_callbackWork.reset();
+	m_hapticsIo.stop();
 	m_io.stop();
-	if (m_ioLoop.joinable()) {
-		m_ioLoop.join();
+	m_callbackIo.stop();
+
+	if (m_hapticsLoop.joinable()) {
+		m_hapticsLoop.join();
+	}
+	for (auto& loop : m_ioLoops) {
+		if (loop.joinable()) {
+			loop.join();
+		}
+	}
+	if (m_callbackLoop.joinable()) {
+		m_callbackLoop.join();
 	}
 }
 
+boost::asio::io_service& IoService::GetHapticsService()
+{
+	return m_hapticsIo;
+}
+
 boost::asio::io_service& IoService::GetIOService()
 {
 	return m_io;
 }
 
+boost::asio::io_service& IoService::GetCallbackService()
+{
+	return m_callbackIo;
+}
@@ -4,21 +4,43 @@
 #include <boost\thread\barrier.hpp>
 #include <atomic>
 #include <thread>
+#include <vector>
+
+//Runs the plugin's asynchronous work on three executors, so that haptic timing is isolated from housekeeping:
+//haptics playback gets an io_service and a thread of its own, at raised priority, while connection monitoring
+//and log draining share a pool of housekeeping threads. Game callbacks get a thread of their own too, since we
+//can't know how long they take.
 class IoService
 {
 public:
-	IoService();
+	explicit IoService(std::size_t housekeepingThreads = 1);
+
+	//Only the haptics tick should run here. It has exactly one thread, so its handlers never overlap.
+	boost::asio::io_service& GetHapticsService();
+
+	//Everything else. The pool may have several threads, so handlers which must not overlap each other
+	//need to go through a strand.
 	boost::asio::io_service& GetIOService();
+
+	//Only calls into game code should run here, so that a slow callback holds up nothing but later callbacks.
+	//It has exactly one thread, so its handlers never overlap.
+	boost::asio::io_service& GetCallbackService();
+
 	void Shutdown();
 private:
-	bool m_running;
-	std::thread m_ioLoop;
+	boost::asio::io_service m_hapticsIo;
 	boost::asio::io_service m_io;
+	boost::asio::io_service m_callbackIo;
+	std::unique_ptr<boost::asio::io_service::work> m_hapticsWork;
 	std::unique_ptr<boost::asio::io_service::work> m_work;
+	std::unique_ptr<boost::asio::io_service::work> m_callbackWork;
+	std::thread m_hapticsLoop;
+	std::thread m_callbackLoop;
+	std::vector<std::thread> m_ioLoops;
 	std::atomic_bool m_shouldQuit;
 
-	void start();
-
+	void start(std::size_t housekeepingThreads);
+	void run(boost::asio::io_service& io);
 
 };
 
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//The point of this is to enable the user to have something like
+// NSVR_Struct_Thing widget = {0};
+// while (NSVR_HasNext(&widget)) {
+//	//do things with widget
+// }
+// The iterator is kept in an IteratorPool, and its handle sticks itself into the void* _internal variable of the struct.
+template<typename T>
+class HiddenIterator {
+public:
+	//Walks the items in place. They're shared and immutable, so nothing is copied.
+	explicit HiddenIterator(std::shared_ptr<const std::vector<T>> items) : m_items(std::move(items)), m_next(0) {}
+	void NextItem(T* original) {
+		*original = (*m_items)[m_next];
+		m_next++;
+	}
+	bool Finished() const {
+		return m_next == m_items->size();
+	}
+private:
+	std::shared_ptr<const std::vector<T>> m_items;
+	std::size_t m_next;
+};
+
+//Owns the HiddenIterators behind the API's iterator structs, which refer to them by handle. Creating, finding and
+//destroying one are all O(1).
+//
+//Callers who stop iterating before the end never tell us, so the pool is capped. Creating an iterator past the cap
+//reclaims the oldest one, whose handle then simply stops being found. That costs a scan of the pool, but only when full.
+//
+//A handle has to fit in a void*, which is only 32 bits on x86. The low bits name the iterator's slot, and the rest hold
+//a serial number which counts every iterator the pool has created, rather than a generation per slot. So a stale handle
+//can only alias a live iterator after the whole pool has created 2^(32 - slot bits) more, not after a few thousand reuses
+//of its own slot; on x64, the serial never wraps at all.
+//
+//Handles are never 0, so a null _internal can mean "not started".
+//This class is not thread safe; synchronization must happen at a higher level
+template<typename T>
+class IteratorPool {
+public:
+	using Handle = uintptr_t;
+
+	explicit IteratorPool(std::size_t capacity);
+
+	Handle Create(std::shared_ptr<const std::vector<T>> items);
+
+	//Null if the handle was destroyed or reclaimed
+	HiddenIterator<T>* Find(Handle handle);
+
+	//Stale handles are ignored
+	void Destroy(Handle handle);
+
+	std::size_t size() const;
+
+	static void* ToInternal(Handle handle) { return reinterpret_cast<void*>(handle); }
+	static Handle FromInternal(void* internal) { return reinterpret_cast<Handle>(internal); }
+
+private:
+	struct Entry {
+		boost::optional<HiddenIterator<T>> Iterator;
+		//0 while the slot is free
+		Handle Issued;
+		//Orders entries by age, for reclaiming the oldest
+		uint64_t Serial;
+	};
+
+	std::vector<Entry> m_entries;
+	std::vector<uint32_t> m_freeSlots;
+	//Slot numbers are stored plus one, so that no handle is ever 0
+	uint32_t m_slotBits;
+	uint64_t m_serial;
+
+	Entry* find(Handle handle);
+	void release(Entry& entry);
+	void reclaimOldest();
+};
+
+template<typename T>
+IteratorPool<T>::IteratorPool(std::size_t capacity)
+	: m_entries(capacity)
+	, m_freeSlots()
+	, m_slotBits(1)
+	, m_serial(0)
+{
+	assert(capacity > 0);
+	while ((std::size_t(1) << m_slotBits) <= capacity) {
+		m_slotBits++;
+	}
+	assert(m_slotBits < sizeof(uint32_t) * 8);
+
+	m_freeSlots.reserve(capacity);
+	for (std::size_t slot = capacity; slot > 0; slot--) {
+		m_freeSlots.push_back(static_cast<uint32_t>(slot - 1));
+	}
+}
+
+template<typename T>
+typename IteratorPool<T>::Handle IteratorPool<T>::Create(std::shared_ptr<const std::vector<T>> items)
+{
+	if (m_freeSlots.empty()) {
+		reclaimOldest();
+	}
+
+	const uint32_t slot = m_freeSlots.back();
+	m_freeSlots.pop_back();
+
+	Entry& entry = m_entries[slot];
+	entry.Serial = ++m_serial;
+	entry.Issued = (static_cast<Handle>(entry.Serial) << m_slotBits) | (slot + 1);
+	entry.Iterator.emplace(std::move(items));
+	return entry.Issued;
+}
+
+template<typename T>
+HiddenIterator<T>* IteratorPool<T>::Find(Handle handle)
+{
+	if (Entry* entry = find(handle)) {
+		return &*entry->Iterator;
+	}
+	return nullptr;
+}
+
+template<typename T>
+void IteratorPool<T>::Destroy(Handle handle)
+{
+	if (Entry* entry = find(handle)) {
+		release(*entry);
+	}
+}
+
+template<typename T>
+std::size_t IteratorPool<T>::size() const
+{
+	return m_entries.size() - m_freeSlots.size();
+}
+
+template<typename T>
+typename IteratorPool<T>::Entry* IteratorPool<T>::find(Handle handle)
+{
+	const std::size_t slot = static_cast<std::size_t>(handle & ((Handle(1) << m_slotBits) - 1));
+	if (handle == 0 || slot == 0 || slot > m_entries.size()) {
+		return nullptr;
+	}
+
+	Entry& entry = m_entries[slot - 1];
+	return entry.Issued == handle ? &entry : nullptr;
+}
+
+template<typename T>
+void IteratorPool<T>::release(Entry& entry)
+{
+	entry.Iterator = boost::none;
+	entry.Issued = 0;
+	m_freeSlots.push_back(static_cast<uint32_t>(&entry - m_entries.data()));
+}
+
+template<typename T>
+void IteratorPool<T>::reclaimOldest()
+{
+	Entry* oldest = nullptr;
+	for (Entry& entry : m_entries) {
+		if (entry.Issued != 0 && (oldest == nullptr || entry.Serial < oldest->Serial)) {
+			oldest = &entry;
+		}
+	}
+	release(*oldest);
+}
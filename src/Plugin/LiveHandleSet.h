@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+//Records which of a SlotMap's handles are live, so that any thread can check one without taking a lock.
+//
+//Each slot gets one atomic word holding the handle currently live in it, or 0. Since a handle carries its slot's
+//generation, a stale handle never matches the word of a slot that has been reused. The words are allocated in
+//fixed-size chunks on first use, and never moved or freed while the set exists, so Contains is wait-free.
+//
+//Insert and Erase may be called from any thread. Only Insert can take a lock, and only to allocate a chunk.
+template<typename Map>
+class LiveHandleSet {
+public:
+	using Handle = typename Map::Handle;
+
+	LiveHandleSet();
+
+	LiveHandleSet(const LiveHandleSet&) = delete;
+	LiveHandleSet& operator=(const LiveHandleSet&) = delete;
+
+	void Insert(Handle handle);
+
+	//Returns false if the handle wasn't live
+	bool Erase(Handle handle);
+
+	bool Contains(Handle handle) const;
+
+	void Clear();
+
+private:
+	static const uint32_t chunk_bits = 12;
+	static const uint32_t chunk_size = 1u << chunk_bits;
+	static const uint32_t max_chunks = (Map::MaxSlots() + chunk_size - 1) / chunk_size;
+
+	using Chunk = std::array<std::atomic<Handle>, chunk_size>;
+
+	std::array<std::atomic<Chunk*>, max_chunks> m_chunks;
+	//Owns the chunks
+	std::array<std::unique_ptr<Chunk>, max_chunks> m_storage;
+	std::mutex m_growLock;
+
+	std::atomic<Handle>* find(Handle handle) const;
+};
+
+template<typename Map>
+LiveHandleSet<Map>::LiveHandleSet()
+	: m_chunks()
+	, m_storage()
+	, m_growLock()
+{
+	for (auto& chunk : m_chunks) {
+		chunk.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+template<typename Map>
+void LiveHandleSet<Map>::Insert(Handle handle)
+{
+	const uint32_t chunkIndex = Map::SlotIndex(handle) >> chunk_bits;
+
+	Chunk* chunk = m_chunks[chunkIndex].load(std::memory_order_acquire);
+	if (chunk == nullptr) {
+		std::lock_guard<std::mutex> guard(m_growLock);
+		if (!m_storage[chunkIndex]) {
+			m_storage[chunkIndex] = std::make_unique<Chunk>();
+			for (auto& word : *m_storage[chunkIndex]) {
+				word.store(0, std::memory_order_relaxed);
+			}
+			m_chunks[chunkIndex].store(m_storage[chunkIndex].get(), std::memory_order_release);
+		}
+		chunk = m_storage[chunkIndex].get();
+	}
+
+	(*chunk)[Map::SlotIndex(handle) & (chunk_size - 1)].store(handle, std::memory_order_release);
+}
+
+template<typename Map>
+bool LiveHandleSet<Map>::Erase(Handle handle)
+{
+	std::atomic<Handle>* word = find(handle);
+	if (word == nullptr) {
+		return false;
+	}
+
+	//Only the caller whose exchange succeeds gets to say it erased the handle
+	Handle expected = handle;
+	return handle != 0 && word->compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+}
+
+template<typename Map>
+bool LiveHandleSet<Map>::Contains(Handle handle) const
+{
+	const std::atomic<Handle>* word = find(handle);
+	return handle != 0 && word != nullptr && word->load(std::memory_order_acquire) == handle;
+}
+
+template<typename Map>
+void LiveHandleSet<Map>::Clear()
+{
+	for (auto& chunk : m_chunks) {
+		if (Chunk* words = chunk.load(std::memory_order_acquire)) {
+			for (auto& word : *words) {
+				word.store(0, std::memory_order_release);
+			}
+		}
+	}
+}
+
+template<typename Map>
+std::atomic<typename LiveHandleSet<Map>::Handle>* LiveHandleSet<Map>::find(Handle handle) const
+{
+	const uint32_t slotIndex = Map::SlotIndex(handle);
+	Chunk* chunk = m_chunks[slotIndex >> chunk_bits].load(std::memory_order_acquire);
+	if (chunk == nullptr) {
+		return nullptr;
+	}
+	return &(*chunk)[slotIndex & (chunk_size - 1)];
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//Bounded, lock-free queue with any number of producers and a single consumer.
+//This is Dmitry Vyukov's bounded queue: each cell carries a sequence number which tells producers and the consumer
+//whether the cell is free to write or ready to read, so neither side ever waits on the other.
+//
+//TryPush may be called from any thread. TryPop must only be called by one thread at a time.
+template<typename T>
+class MpscQueue {
+public:
+	//Precondition: capacity is a power of two
+	explicit MpscQueue(std::size_t capacity);
+	~MpscQueue();
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	//Returns false if the queue is full, in which case value is left untouched
+	bool TryPush(T&& value);
+
+	//Returns false if the queue is empty
+	bool TryPop(T* outValue);
+
+private:
+	struct Cell {
+		std::atomic<std::size_t> sequence;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	const std::size_t m_mask;
+
+	//Producers and the consumer touch different ends of the queue, so keep them on separate cache lines
+	alignas(64) std::atomic<std::size_t> m_enqueuePos;
+	alignas(64) std::size_t m_dequeuePos;
+
+	T* valueIn(Cell& cell);
+};
+
+template<typename T>
+MpscQueue<T>::MpscQueue(std::size_t capacity)
+	: m_cells(new Cell[capacity])
+	, m_mask(capacity - 1)
+	, m_enqueuePos(0)
+	, m_dequeuePos(0)
+{
+	assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+
+	for (std::size_t i = 0; i < capacity; i++) {
+		m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template<typename T>
+MpscQueue<T>::~MpscQueue()
+{
+	T discarded;
+	while (TryPop(&discarded)) {}
+}
+
+template<typename T>
+bool MpscQueue<T>::TryPush(T&& value)
+{
+	std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		Cell& cell = m_cells[pos & m_mask];
+		std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+		if (diff == 0) {
+			//The cell is free; claim it. If another producer beat us to it, pos is reloaded and we try again
+			if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				new (&cell.storage) T(std::move(value));
+				cell.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0) {
+			//The consumer hasn't freed this cell yet, so the queue is full
+			return false;
+		}
+		else {
+			pos = m_enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename T>
+bool MpscQueue<T>::TryPop(T* outValue)
+{
+	Cell& cell = m_cells[m_dequeuePos & m_mask];
+	std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+	std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(m_dequeuePos + 1);
+
+	if (diff < 0) {
+		//Either empty, or a producer has claimed the cell but not finished writing it
+		return false;
+	}
+
+	T* value = valueIn(cell);
+	*outValue = std::move(*value);
+	value->~T();
+
+	//Mark the cell as free for the producer that comes around on the next lap
+	cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+	m_dequeuePos++;
+	return true;
+}
+
+template<typename T>
+T* MpscQueue<T>::valueIn(Cell& cell)
+{
+	return reinterpret_cast<T*>(&cell.storage);
+}
@@ -6,6 +6,11 @@
 
 
 MyTestLog::MyTestLog()
+	: m_messenger(nullptr)
+	, m_log()
+	, m_strand(nullptr)
+	, m_readDriverLogs()
+	, m_logLock()
 {
 }
 
@@ -20,20 +25,29 @@ void MyTestLog::consume(const boost::log::record_view& msg)
 }
 
 //this is basically the constructor
-void MyTestLog::Provide(ClientMessenger* messenger, boost::asio::io_service& io)
+void MyTestLog::Provide(ClientMessenger* messenger, boost::asio::io_service::strand& strand)
 {
 	m_messenger = messenger;
-	m_readDriverLogs = std::make_unique<ScheduledEvent>(io, boost::posix_time::milliseconds(50));
-	m_readDriverLogs->SetEvent([this]() {
+	m_strand = &strand;
+	m_readDriverLogs = std::make_unique<boost::asio::deadline_timer>(strand.get_io_service());
+	scheduleReadDriverLogs();
+}
+
+void MyTestLog::scheduleReadDriverLogs()
+{
+	m_readDriverLogs->expires_from_now(boost::posix_time::milliseconds(50));
+	m_readDriverLogs->async_wait(m_strand->wrap([this](const boost::system::error_code& ec) {
+		if (ec) {
+			return;
+		}
 
 		auto optionalLog = m_messenger->ReadLog();
 		if (optionalLog) {
 			addEntry(*optionalLog);
 		}
 
-	});
-
-	m_readDriverLogs->Start();
+		scheduleReadDriverLogs();
+	}));
 }
 
 boost::optional<std::string> MyTestLog::Poll()
@@ -4,9 +4,10 @@
 #include <boost\log\sinks\frontend_requirements.hpp>
 #include "ClientMessenger.h"
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/deadline_timer.hpp>
 #include <deque>
 #include <memory>
-#include "ScheduledEvent.h"
 
 class MyTestLog : public boost::log::sinks::basic_sink_backend<
 	boost::log::sinks::combine_requirements<
@@ -19,15 +20,18 @@ public:
 
 	void consume(const boost::log::record_view& msg);
 
-	void Provide(ClientMessenger* messenger, boost::asio::io_service& io);
+	//Driver logs are drained on the messenger's connection strand, since reading them touches the connection
+	void Provide(ClientMessenger* messenger, boost::asio::io_service::strand& strand);
 
 	boost::optional<std::string> Poll();
 private:
 	ClientMessenger* m_messenger;
 	std::deque<std::string> m_log;
-	std::unique_ptr<ScheduledEvent> m_readDriverLogs;
+	boost::asio::io_service::strand* m_strand;
+	std::unique_ptr<boost::asio::deadline_timer> m_readDriverLogs;
 	std::mutex m_logLock;
 
 	void addEntry(std::string entry);
+	void scheduleReadDriverLogs();
 };
 
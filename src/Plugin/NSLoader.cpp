@@ -72,23 +72,7 @@ HLVR_RETURN(HLVR_Result) HLVR_DeviceIterator_Next(HLVR_DeviceIterator* iter, HLV
 	RETURN_FALSE_IF_NULL(iter);
 	RETURN_FALSE_IF_NULL(system);
 	return ExceptionGuard([iter, system]() {
-		if (iter->_internal == nullptr) {
-			HiddenIterator<HLVR_DeviceInfo>* snapshot = AS_TYPE(Engine, system)->TakeDeviceSnapshot();
-			iter->_internal = snapshot;
-		}
-
-
-		HiddenIterator<HLVR_DeviceInfo>* iterator = AS_TYPE(HiddenIterator<HLVR_DeviceInfo>, iter->_internal);
-
-		if (iterator->Finished()) {
-			AS_TYPE(Engine, system)->DestroyIterator(iterator);
-			iter->_internal = nullptr;
-			RETURN(HLVR_Error_NoMoreDevices);
-		}
-
-		iterator->NextItem(&iter->DeviceInfo);
-
-		RETURN(HLVR_Ok);
+		return AS_TYPE(Engine, system)->NextDevice(iter);
 	});
 }
 
@@ -105,21 +89,53 @@ HLVR_RETURN(int) HLVR_NodeIterator_Next(HLVR_NodeIterator * iter, uint32_t devic
 	RETURN_FALSE_IF_NULL(system);
 
 	return ExceptionGuard([iter, system, device_id]() {
+		return AS_TYPE(Engine, system)->NextNode(iter, device_id);
+	});
+}
 
-		if (iter->_internal == nullptr) {
-			HiddenIterator<HLVR_NodeInfo>* snapshot = AS_TYPE(Engine, system)->TakeNodeSnapshot(device_id);
-			iter->_internal = snapshot;
-		}
+HLVR_RETURN_EXP(HLVR_Result) HLVR_DeviceIterator_Destroy(HLVR_DeviceIterator* iter, HLVR_System* system)
+{
+	RETURN_IF_NULL(iter);
+	RETURN_IF_NULL(system);
 
-		HiddenIterator<HLVR_NodeInfo>* iterator = AS_TYPE(HiddenIterator<HLVR_NodeInfo>, iter->_internal);
-		if (iterator->Finished()) {
-			AS_TYPE(Engine, system)->DestroyIterator(iterator);
-			iter->_internal = nullptr;
-			RETURN(HLVR_Error_NoMoreNodes);
-		}
+	return ExceptionGuard([&] {
+		AS_TYPE(Engine, system)->DestroyIterator(iter);
+		return HLVR_Ok;
+	});
+}
 
-		iterator->NextItem(&iter->NodeInfo);
-		RETURN(HLVR_Ok);
+HLVR_RETURN_EXP(HLVR_Result) HLVR_DeviceIterator_Reset(HLVR_DeviceIterator* iter, HLVR_System* system)
+{
+	RETURN_IF_NULL(iter);
+	RETURN_IF_NULL(system);
+
+	return ExceptionGuard([&] {
+		AS_TYPE(Engine, system)->DestroyIterator(iter);
+		iter->DeviceInfo = { 0 };
+		return HLVR_Ok;
+	});
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_NodeIterator_Destroy(HLVR_NodeIterator* iter, HLVR_System* system)
+{
+	RETURN_IF_NULL(iter);
+	RETURN_IF_NULL(system);
+
+	return ExceptionGuard([&] {
+		AS_TYPE(Engine, system)->DestroyIterator(iter);
+		return HLVR_Ok;
+	});
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_NodeIterator_Reset(HLVR_NodeIterator* iter, HLVR_System* system)
+{
+	RETURN_IF_NULL(iter);
+	RETURN_IF_NULL(system);
+
+	return ExceptionGuard([&] {
+		AS_TYPE(Engine, system)->DestroyIterator(iter);
+		iter->NodeInfo = { 0 };
+		return HLVR_Ok;
 	});
 }
 
@@ -225,6 +241,59 @@ HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetGravity(HLVR_System * ptr,
 	});
 }
 
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetAll(HLVR_System* ptr, HLVR_TrackingSample* outSamples, uint32_t capacity, uint32_t* outCount, uint64_t* inOutSequence)
+{
+	RETURN_IF_NULL(ptr);
+	RETURN_IF_NULL(outCount);
+	RETURN_IF_NULL(inOutSequence);
+	if (capacity > 0) {
+		RETURN_IF_NULL(outSamples);
+	}
+
+	return ExceptionGuard([&] {
+		return AS_TYPE(Engine, ptr)->GetAllTracking(outSamples, capacity, outCount, inOutSequence);
+	});
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetTime(HLVR_System* ptr, uint64_t* outMicroseconds)
+{
+	RETURN_IF_NULL(ptr);
+	RETURN_IF_NULL(outMicroseconds);
+
+	return ExceptionGuard([&] {
+		return AS_TYPE(Engine, ptr)->GetTrackingTime(outMicroseconds);
+	});
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetOrientationAt(HLVR_System* ptr, uint32_t region, uint64_t timestampMicroseconds, HLVR_Quaternion* outOrientation)
+{
+	RETURN_IF_NULL(ptr);
+	RETURN_IF_NULL(outOrientation);
+
+	return ExceptionGuard([&] {
+		return AS_TYPE(Engine, ptr)->GetOrientationAt(region, timestampMicroseconds, outOrientation);
+	});
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Subscribe(HLVR_System* ptr, HLVR_TrackingCallback callback, void* userData)
+{
+	RETURN_IF_NULL(ptr);
+	RETURN_IF_NULL(callback);
+
+	return ExceptionGuard([&] {
+		return AS_TYPE(Engine, ptr)->SubscribeTracking(callback, userData);
+	});
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Unsubscribe(HLVR_System* ptr)
+{
+	RETURN_IF_NULL(ptr);
+
+	return ExceptionGuard([&] {
+		return AS_TYPE(Engine, ptr)->UnsubscribeTracking();
+	});
+}
+
 HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Enable(HLVR_System * ptr, uint32_t device_id)
 {
 	RETURN_IF_NULL(ptr);
@@ -251,6 +320,51 @@ HLVR_RETURN_EXP(HLVR_Result) HLVR_System_PushEvent(HLVR_System* system, HLVR_Eve
 	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->StreamEvent(*AS_TYPE(TypedEvent, data)); });
 }
 
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_SetHapticsTickInterval(HLVR_System* system, uint32_t milliseconds)
+{
+	RETURN_IF_NULL(system);
+
+	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->SetHapticsTickInterval(milliseconds); });
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_GetTimingStats(HLVR_System* system, HLVR_TimingStats* outStats)
+{
+	RETURN_IF_NULL(system);
+	RETURN_IF_NULL(outStats);
+
+	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->GetTimingStats(outStats); });
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_EnableRealtimeHaptics(HLVR_System* system, const HLVR_RealtimeHapticsOptions* options)
+{
+	RETURN_IF_NULL(system);
+
+	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->EnableRealtimeHaptics(options); });
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_DisableRealtimeHaptics(HLVR_System* system)
+{
+	RETURN_IF_NULL(system);
+
+	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->DisableRealtimeHaptics(); });
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_GetRealtimeHapticsStats(HLVR_System* system, HLVR_RealtimeHapticsStats* outStats)
+{
+	RETURN_IF_NULL(system);
+	RETURN_IF_NULL(outStats);
+
+	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->GetRealtimeHapticsStats(outStats); });
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_System_GetEffectCacheStats(HLVR_System* system, HLVR_EffectCacheStats* outStats)
+{
+	RETURN_IF_NULL(system);
+	RETURN_IF_NULL(outStats);
+
+	return ExceptionGuard([&] { return AS_TYPE(Engine, system)->GetEffectCacheStats(outStats); });
+}
+
 
 
 
@@ -370,6 +484,31 @@ HLVR_RETURN(HLVR_Result) HLVR_Timeline_AddEvent(HLVR_Timeline * timeline, double
 }
 
 
+HLVR_RETURN_EXP(HLVR_Result) HLVR_Timeline_AddEventMove(HLVR_Timeline * timeline, double timeOffsetSeconds, HLVR_Event ** event)
+{
+	RETURN_IF_NULL(timeline);
+	RETURN_IF_NULL(event);
+	RETURN_IF_NULL(*event);
+
+	if (timeOffsetSeconds < 0.0f) {
+		RETURN(HLVR_Error_InvalidTimeOffset);
+	}
+
+	return ExceptionGuard([&] {
+		TypedEvent* typedEvent = AS_TYPE(TypedEvent, *event);
+		auto result = AS_TYPE(EventList, timeline)->AddEvent(
+			TimeOffset<TypedEvent> {
+				static_cast<float>(timeOffsetSeconds),
+				std::move(*typedEvent)
+			}
+		);
+		delete typedEvent;
+		*event = nullptr;
+		return result;
+	});
+}
+
+
 HLVR_RETURN(HLVR_Result) HLVR_Timeline_Create(HLVR_Timeline** timelinePtr)
  {
 
@@ -410,6 +549,26 @@ HLVR_RETURN(HLVR_Result) HLVR_Event_Validate(const HLVR_Event * event, HLVR_Even
 
 
 
+//Binds the handle to whatever create(engine, &newHandle) makes, releasing anything it was bound to before
+template<typename CreateFn>
+HLVR_Result transmitInto(Engine* engine, PlaybackHandle* handle, CreateFn&& create)
+{
+	//If this effect was already attached to something playing, we want to release that previously playing thing
+	//so that it can eventually be cleaned up. Else it will dangle. It belongs to the engine it was created on,
+	//which needn't be the one creating the new effect.
+	if (handle->IsBound() && handle->engine != nullptr) {
+		handle->engine->ReleaseHandle(handle->handle);
+	}
+	
+	EffectHandle newHandle = 0;
+	auto retCode = create(engine, &newHandle);
+	if (HLVR_OK(retCode)) {
+		//Only modify the state of the handle if the engine was able to successfully create the effect
+		handle->bind(newHandle, engine);
+	}
+	return retCode;
+}
+
 HLVR_RETURN(HLVR_Result) HLVR_Timeline_Transmit(const HLVR_Timeline * timelinePtr, HLVR_System* systemPtr, HLVR_Effect * handlePtr)
  {
 	 RETURN_IF_NULL(systemPtr);
@@ -417,38 +576,56 @@ HLVR_RETURN(HLVR_Result) HLVR_Timeline_Transmit(const HLVR_Timeline * timelinePt
 	 RETURN_IF_NULL(handlePtr);
 
 	 return ExceptionGuard([&] {
-
-		//Doing a lot of reinterpret_casts here, so I get it out of the way first.
-		auto engine = AS_TYPE(Engine, systemPtr);
 		auto timeline = AS_TYPE(const EventList, timelinePtr);
-		auto handle = AS_TYPE(PlaybackHandle, handlePtr);
-
-
-		//If this effect was already attached to something playing, we want to release that previously playing thing
-		//so that it can eventually be cleaned up. Else it will dangle. 
-		if (handle->IsBound()) {
-			engine->ReleaseHandle(handle->handle);
-		}
-		
-		EffectHandle newHandle = 0;
-		auto retCode = engine->CreateEffect(timeline, &newHandle);
-		if (HLVR_OK(retCode)) {
-			//Only modify the state of the handle if the engine was able to successfully create the effect
-			handle->bind(newHandle, engine);
-		}
-		return retCode;
-		 
+		return transmitInto(AS_TYPE(Engine, systemPtr), AS_TYPE(PlaybackHandle, handlePtr), [timeline](Engine* engine, EffectHandle* newHandle) {
+			return engine->CreateEffect(timeline, newHandle);
+		});
 	 });
  }
 
+HLVR_RETURN_EXP(HLVR_Result) HLVR_Timeline_TransmitMove(HLVR_Timeline * timelinePtr, HLVR_System * systemPtr, HLVR_Effect * handlePtr)
+{
+	RETURN_IF_NULL(systemPtr);
+	RETURN_IF_NULL(timelinePtr);
+	RETURN_IF_NULL(handlePtr);
 
+	return ExceptionGuard([&] {
+		auto timeline = AS_TYPE(EventList, timelinePtr);
+		return transmitInto(AS_TYPE(Engine, systemPtr), AS_TYPE(PlaybackHandle, handlePtr), [timeline](Engine* engine, EffectHandle* newHandle) {
+			return engine->CreateEffectConsuming(timeline, newHandle);
+		});
+	});
+}
 
 HLVR_RETURN(HLVR_Result) HLVR_Effect_Create(HLVR_Effect ** handlePtr)
  {
 	 return ExceptionGuard([&] {
 		 *handlePtr = AS_TYPE(HLVR_Effect, new PlaybackHandle());
 		 return HLVR_Ok;
-	 }); 
+	 });
+}
+
+HLVR_RETURN_EXP(HLVR_Result) HLVR_Effect_Instantiate(const HLVR_Effect * sourcePtr, HLVR_Effect * instancePtr)
+{
+	RETURN_IF_NULL(sourcePtr);
+	RETURN_IF_NULL(instancePtr);
+
+	return ExceptionGuard([&] {
+		auto source = AS_TYPE(const PlaybackHandle, sourcePtr);
+		if (source->engine == nullptr) {
+			RETURN(HLVR_Error_EmptyHandle);
+		}
+
+		//Instantiating an effect from itself would release the source before it could be read
+		if (sourcePtr == instancePtr) {
+			RETURN(HLVR_Error_InvalidArgument);
+		}
+
+		const uint32_t sourceHandle = source->handle;
+		return transmitInto(source->engine, AS_TYPE(PlaybackHandle, instancePtr), [sourceHandle](Engine* engine, EffectHandle* newHandle) {
+			return engine->InstantiateEffect(sourceHandle, newHandle);
+		});
+	});
 }
 
 HLVR_RETURN(HLVR_Result) HLVR_Effect_Pause(HLVR_Effect* effect) {
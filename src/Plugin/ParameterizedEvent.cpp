@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "ParameterizedEvent.h"
 #include "HLVR.h"
+#include <boost/functional/hash.hpp>
 
 
 TypedEvent::TypedEvent(HLVR_EventType type) 
@@ -10,8 +11,6 @@ TypedEvent::TypedEvent(HLVR_EventType type)
 ParameterizedEvent::ParameterizedEvent()
 	: m_params()
 {
-	//Trying to avoid a resize
-	m_params.reserve(5);
 }
 
 
@@ -21,6 +20,11 @@ bool ParameterizedEvent::HasKey(HLVR_EventKey key) const
 	return findParam(key) != nullptr;
 }
 
+std::size_t ParameterizedEvent::size() const
+{
+	return m_params.size();
+}
+
 
 event_param* ParameterizedEvent::findParam(HLVR_EventKey key)
 {
@@ -31,18 +35,54 @@ event_param* ParameterizedEvent::findParam(HLVR_EventKey key)
 
 const event_param * ParameterizedEvent::findParam(HLVR_EventKey key) const
 {
-	for (const auto& param : m_params) {
-		if (param.key == key) {
-			return &param;
-		}
+	auto by_key = [](const event_param& param, HLVR_EventKey key) { return param.key < key; };
+	auto found = std::lower_bound(m_params.begin(), m_params.end(), key, by_key);
+	if (found != m_params.end() && found->key == key) {
+		return &*found;
 	}
 	return nullptr;
 }
 
 
 
+bool ParameterizedEvent::operator==(const ParameterizedEvent & other) const
+{
+	if (m_params.size() != other.m_params.size()) {
+		return false;
+	}
+
+	//Both sides are sorted by key, so equal events line up
+	for (std::size_t i = 0; i < m_params.size(); i++) {
+		if (m_params[i].key != other.m_params[i].key || !(m_params[i].value == other.m_params[i].value)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+class hash_value_visitor : public boost::static_visitor<std::size_t> {
+public:
+	template<typename T>
+	std::size_t operator()(const T& value) const {
+		return boost::hash_value(value);
+	}
+};
+
+std::size_t ParameterizedEvent::Hash() const
+{
+	std::size_t seed = 0;
+	for (const auto& param : m_params) {
+		boost::hash_combine(seed, static_cast<int>(param.key));
+		boost::hash_combine(seed, param.value.which());
+		boost::hash_combine(seed, boost::apply_visitor(hash_value_visitor(), param.value));
+	}
+	return seed;
+}
+
+
 event_param::event_param(HLVR_EventKey key, EventValue val)
 	: key(key)
-	, value(val)
+	, value(std::move(val))
 {
 }
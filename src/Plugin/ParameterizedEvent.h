@@ -2,7 +2,9 @@
 #include "HLVR_Forwards.h"
 #include <boost/variant.hpp>
 #include <boost/optional.hpp>
+#include <boost/container/small_vector.hpp>
 
+#include <algorithm>
 #include <mutex>
 #include <vector>
 
@@ -35,6 +37,20 @@ struct event_param {
 };
 
 
+//A borrowed view of an array parameter, valid until the parameter is next set or the event is destroyed
+template<typename T>
+struct ArrayView {
+	const T* data;
+	std::size_t size;
+
+	const T* begin() const { return data; }
+	const T* end() const { return data + size; }
+	bool empty() const { return size == 0; }
+};
+
+//Parameters are kept sorted by key in a small inline buffer; events rarely have more than a handful, so most never
+//touch the heap for the map itself.
+//None of the getters throw on a missing key or a type mismatch.
 class ParameterizedEvent
 {
 public:
@@ -46,6 +62,14 @@ public:
 	template<typename ArrayType>
 	bool Set(HLVR_EventKey key, const ArrayType* values, unsigned int length);
 
+	//Returns the value if it is present and of type T, otherwise nullptr
+	template<typename T>
+	const T* Find(HLVR_EventKey key) const;
+
+	//Returns an empty view if the array is missing or holds a different type
+	template<typename T>
+	ArrayView<T> GetArray(HLVR_EventKey key) const;
+
 	template<typename T>
 	T GetOr(HLVR_EventKey key, T defaultValue) const;
 
@@ -55,10 +79,28 @@ public:
 	template<typename T>
 	bool TryGet(HLVR_EventKey key, T* outVal) const;
 
+	//Moves the value out and removes the parameter. Like TryGet, leaves outVal alone on failure.
+	template<typename T>
+	bool Take(HLVR_EventKey key, T* outVal);
+
 	bool HasKey(HLVR_EventKey key) const;
 
+	//Number of parameters
+	std::size_t size() const;
+
+	//Calls fn(param) for each parameter, in order of key
+	template<typename Fn>
+	void ForEach(Fn&& fn) const;
+
+	//Equal if every key holds an equal value of the same type
+	bool operator==(const ParameterizedEvent& other) const;
+
+	//Consistent with operator==
+	std::size_t Hash() const;
+
 private:
-	std::vector<event_param> m_params;
+	static const std::size_t inline_params = 6;
+	boost::container::small_vector<event_param, inline_params> m_params;
 
 	event_param* findParam(HLVR_EventKey key);
 	const event_param* findParam(HLVR_EventKey key) const;
@@ -77,7 +119,7 @@ struct TypedEvent {
 template<class T>
 inline bool ParameterizedEvent::Set(HLVR_EventKey key, T value)
 {
-	updateOrAdd<T>(key, value);
+	updateOrAdd<T>(key, std::move(value));
 	return true;
 }
 
@@ -91,60 +133,91 @@ inline bool ParameterizedEvent::Set(HLVR_EventKey key, const ArrayType * values,
 
 
 template<typename T>
-inline T ParameterizedEvent::GetOr(HLVR_EventKey key, T defaultValue) const
+inline const T* ParameterizedEvent::Find(HLVR_EventKey key) const
 {
-	try {
-		if (const event_param* prop = findParam(key)) {
-			return boost::get<T>(prop->value);
-		}
-		else {
-			return defaultValue;
-		}
+	if (const event_param* prop = findParam(key)) {
+		return boost::get<T>(&prop->value);
 	}
-	catch (const boost::bad_get&) {
-		return defaultValue;
+
+	return nullptr;
+}
+
+template<typename T>
+inline ArrayView<T> ParameterizedEvent::GetArray(HLVR_EventKey key) const
+{
+	if (const std::vector<T>* values = Find<std::vector<T>>(key)) {
+		return ArrayView<T>{ values->data(), values->size() };
 	}
+
+	return ArrayView<T>{ nullptr, 0 };
 }
 
-//TryGet will not modify outVal if it fails to get the value
 template<typename T>
-boost::optional<T> ParameterizedEvent::TryGet(HLVR_EventKey key) const
+inline T ParameterizedEvent::GetOr(HLVR_EventKey key, T defaultValue) const
 {
-	try {
-		if (const event_param* prop = findParam(key)) {
-			return boost::get<T>(prop->value)
-		}
+	if (const T* value = Find<T>(key)) {
+		return *value;
 	}
-	catch (const boost::bad_get&) {
-		//noop
+
+	return defaultValue;
+}
+
+template<typename T>
+boost::optional<T> ParameterizedEvent::TryGet(HLVR_EventKey key) const
+{
+	if (const T* value = Find<T>(key)) {
+		return *value;
 	}
 
 	return boost::none;
 }
 
-
+//TryGet will not modify outVal if it fails to get the value
 template<typename T>
 bool ParameterizedEvent::TryGet(HLVR_EventKey key, T* outVal) const {
-	try {
-		if (const event_param* prop = findParam(key)) {
-			*outVal = boost::get<T>(prop->value);
-			return true;
-		}
-	}
-	catch (const boost::bad_get&) {
-		//noop
+	if (const T* value = Find<T>(key)) {
+		*outVal = *value;
+		return true;
 	}
 
 	return false;
 }
+
+template<typename T>
+bool ParameterizedEvent::Take(HLVR_EventKey key, T* outVal) {
+	event_param* prop = findParam(key);
+	if (prop == nullptr) {
+		return false;
+	}
+
+	T* value = boost::get<T>(&prop->value);
+	if (value == nullptr) {
+		return false;
+	}
+
+	*outVal = std::move(*value);
+	m_params.erase(m_params.begin() + (prop - m_params.data()));
+	return true;
+}
+
+template<typename Fn>
+inline void ParameterizedEvent::ForEach(Fn&& fn) const
+{
+	for (const event_param& param : m_params) {
+		fn(param);
+	}
+}
+
 template<typename T>
 inline void ParameterizedEvent::updateOrAdd(HLVR_EventKey key, T val)
 {
-	if (event_param* existing = findParam(key)) {
-		existing->value = val;
+	auto by_key = [](const event_param& param, HLVR_EventKey key) { return param.key < key; };
+	auto existing = std::lower_bound(m_params.begin(), m_params.end(), key, by_key);
+	if (existing != m_params.end() && existing->key == key) {
+		existing->value = std::move(val);
 	}
 	else {
-		m_params.emplace_back(key, val);
+		m_params.emplace(existing, key, std::move(val));
 	}
 }
 
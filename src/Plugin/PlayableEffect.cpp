@@ -10,60 +10,60 @@
 #pragma warning(pop)
 
 #include "HLVR.h"
-#include <numeric> //std::accumulate
-
 
+#include <cmath>
 
 
+//The parent_id field of a HighLevelEvent, on its own. Put in front of an event's precomputed bytes, it makes the full message.
+std::string encodeParentId(uint64_t parentId) {
+	NullSpaceIPC::HighLevelEvent event;
+	event.set_parent_id(parentId);
+	return event.SerializeAsString();
+}
 
 
-PlayableEffect::PlayableEffect(std::vector<PlayablePtr> effects, boost::uuids::uuid uuid, ClientMessenger& messenger) 
+PlayableEffect::PlayableEffect(std::shared_ptr<const EffectProgram> program, uint64_t id, ClientMessenger& messenger) 
 	: m_state(PlaybackState::IDLE)
 	, m_time(0.f) //fractional seconds, e.g. 1.5 is one and one half of a second. We should make this a type.
-	, m_effects(std::move(effects))
-	, m_id(std::move(uuid))
-	, m_messenger(messenger)
+	, m_startedAt(0)
+	, m_epoch(0)
+	, m_program(std::move(program))
+	, m_nextEvent(0)
+	, m_id(id)
+	, m_encodedId(encodeParentId(m_id))
+	, m_messenger(&messenger)
 	, m_isReleased(false)
+	, m_status(std::make_shared<PlaybackStatus>())
 {
-	assert(!m_effects.empty());
-
-	sortByTime(&m_effects);
-	removeDuplicates(&m_effects);
+	assert(m_program);
 
 	scrubToBegin();
+	publishStatus();
 }
 
-
-void sortByTime(std::vector<PlayablePtr>* playables)
+PlayerTime toPlayerTime(float seconds)
 {
-	auto by_time = [](const auto& lhs, const auto& rhs) { 
-		return lhs->time() < rhs->time(); 
-	};
-	std::sort(playables->begin(), playables->end(), by_time);
+	return PlayerTime(std::llround(static_cast<double>(seconds) * 1000000.0));
 }
 
-
-void removeDuplicates(std::vector<PlayablePtr>* playables) {
-	
-	auto value_equality = [](const auto& lhs, const auto& rhs) {
-		return *lhs == *rhs;
-	};
-
- 	auto last = std::unique(playables->begin(), playables->end(), value_equality);
-	playables->erase(last, playables->end());
-	playables->shrink_to_fit();
+float toSeconds(PlayerTime time)
+{
+	return static_cast<float>(time.count() / 1000000.0);
 }
 
-
-void PlayableEffect::Play()
+void PlayableEffect::Play(PlayerTime now)
 {
 	switch (m_state) {
 	case PlaybackState::IDLE:
 		scrubToBegin();
+		m_startedAt = now;
+		m_epoch++;
 		m_state = PlaybackState::PLAYING;
 		break;
 	case PlaybackState::PAUSED:
 		resume();
+		m_startedAt = now - toPlayerTime(m_time);
+		m_epoch++;
 		m_state = PlaybackState::PLAYING;
 		break;
 	case PlaybackState::PLAYING:
@@ -72,9 +72,11 @@ void PlayableEffect::Play()
 	default:
 		break;
 	}
+
+	publishStatus();
 }
 
-void PlayableEffect::Stop()
+void PlayableEffect::Stop(PlayerTime now)
 {
 	switch (m_state) {
 		case PlaybackState::IDLE:
@@ -86,14 +88,17 @@ void PlayableEffect::Stop()
 			break;
 		case PlaybackState::PLAYING:
 			reset();
+			m_time = CurrentTime(now);
 			m_state = PlaybackState::IDLE;
 			break;
 		default:
 			break;
 	}
+
+	publishStatus();
 }
 
-void PlayableEffect::Pause()
+void PlayableEffect::Pause(PlayerTime now)
 {
 	switch (m_state) {
 	case PlaybackState::IDLE:
@@ -104,82 +109,64 @@ void PlayableEffect::Pause()
 		break;
 	case PlaybackState::PLAYING:
 		pause();
+		m_time = CurrentTime(now);
 		m_state = PlaybackState::PAUSED;
 		break;
 	default:
 		break;
 	}
-	
-	
-}
 
-//Right now, we are using UUID to uniquely identify each event. We probably (?) shouldn't be truncating a UUID like I am below.
-//The other option which I have tried is to send over a byte array representing the full
-//UUID. I think this is overkill, and it means we need to pass it on the hardware plugins as well.
-uint64_t truncatedUuid(const boost::uuids::uuid& uuid) {
-	uint64_t truncatedId = 0;
-	memcpy_s(&truncatedId, sizeof(truncatedId), uuid.data, sizeof uint64_t);
-	return truncatedId;
+	publishStatus();
 }
 
-NullSpaceIPC::HighLevelEvent makeEvent(const boost::uuids::uuid& parentId, const PlayableEvent& event) {
-	
-	using namespace NullSpaceIPC;
-	HighLevelEvent abstract_event;
 
-	abstract_event.set_parent_id(truncatedUuid(parentId));
-	event.serialize(abstract_event);
-	return abstract_event;
+void PlayableEffect::Fire(std::size_t eventIndex)
+{
+	assert(eventIndex < m_program->Events().size());
+
+	//No protobuf work here: the program encoded its events up front, and we encoded our id
+	EncodedBytes id{ m_encodedId.data(), m_encodedId.size() };
+	m_messenger->WriteEncodedEvent(id, m_program->Events().Encoded(eventIndex));
+	m_nextEvent = eventIndex + 1;
 }
 
-void PlayableEffect::Update(float dt)
+std::size_t PlayableEffect::NextEvent() const
 {
-	if (m_state == PlaybackState::IDLE || m_state == PlaybackState::PAUSED) {
-		return;
-	}
+	return m_nextEvent;
+}
 
-	m_time += dt;
-	
-	auto current(m_lastExecutedEffect);
-
-	auto isTimeExpired = [this](const PlayableEvent& event) {
-		return event.time() <= m_time;
-	};
-
-	
-	while (current != m_effects.end()) {
-		if (isTimeExpired(*current->get())) {
-			NullSpaceIPC::HighLevelEvent event = makeEvent(m_id, *current->get());			
-			m_messenger.WriteEvent(event);
-			std::advance(current, 1);
-		}
-		else {
-			//Precondition: effects vector must be sorted by time (which we do in the constructor)
-			//Given that, we can stop here because if this effect wasn't expired, then the next won't be either
-			break;
-		}
-	}
+std::size_t PlayableEffect::EventCount() const
+{
+	return m_program->Events().size();
+}
 
-	m_lastExecutedEffect = current;
+PlayerTime PlayableEffect::EventDue(std::size_t eventIndex) const
+{
+	return m_startedAt + toPlayerTime(std::max(0.0f, m_program->Events()[eventIndex].time));
+}
 
-	//Automatically stop when we exceed the total duration of the effect
-	if (m_time >= GetTotalDuration()) {
-		Stop();
-	}
+PlayerTime PlayableEffect::EndDue() const
+{
+	return m_startedAt + toPlayerTime(GetTotalDuration());
+}
 
-} 
+uint32_t PlayableEffect::Epoch() const
+{
+	return m_epoch;
+}
 
 
 float PlayableEffect::GetTotalDuration() const
 {
-	return std::accumulate(m_effects.begin(), m_effects.end(), 0.0f, [](float currentDuration, const auto& effect) {
-		float thisEffectEndTime = std::max(0.0f, effect->duration() + effect->time());
-		return std::max(currentDuration, thisEffectEndTime);
-	});
+	return m_program->Metadata().Duration;
 }
 
-float PlayableEffect::CurrentTime() const
+float PlayableEffect::CurrentTime(PlayerTime now) const
 {
+	if (m_state == PlaybackState::PLAYING) {
+		return toSeconds(now - m_startedAt);
+	}
+
 	return m_time;
 }
 
@@ -193,9 +180,31 @@ bool PlayableEffect::IsReleased() const
 	return m_isReleased;
 }
 
-EffectInfo PlayableEffect::GetInfo() const
+EffectInfo PlayableEffect::ReadInfo(const EffectMetadata& metadata, const PlaybackStatus& status, PlayerTime now)
 {
-	return EffectInfo{ GetTotalDuration(), m_time, (int)m_state };
+	int state = status.State.load(std::memory_order_relaxed);
+	float currentTime = status.CurrentTime.load(std::memory_order_relaxed);
+	if (state == static_cast<int>(PlaybackState::PLAYING)) {
+		currentTime = toSeconds(now - PlayerTime(status.StartedAt.load(std::memory_order_relaxed)));
+	}
+
+	return EffectInfo{ metadata.Duration, currentTime, state };
+}
+
+std::shared_ptr<const EffectProgram> PlayableEffect::GetProgram() const
+{
+	return m_program;
+}
+
+std::shared_ptr<const EffectMetadata> PlayableEffect::GetMetadata() const
+{
+	//Shares ownership of the program, which the metadata is part of
+	return std::shared_ptr<const EffectMetadata>(m_program, &m_program->Metadata());
+}
+
+std::shared_ptr<const PlaybackStatus> PlayableEffect::GetStatus() const
+{
+	return m_status;
 }
 
 void PlayableEffect::Release()
@@ -203,12 +212,19 @@ void PlayableEffect::Release()
 	m_isReleased = true;	
 }
 
+void PlayableEffect::publishStatus()
+{
+	m_status->CurrentTime.store(m_time, std::memory_order_relaxed);
+	m_status->StartedAt.store(m_startedAt.count(), std::memory_order_relaxed);
+	m_status->State.store(static_cast<int>(m_state), std::memory_order_relaxed);
+}
+
 
-NullSpaceIPC::HighLevelEvent makePlaybackEvent(const boost::uuids::uuid& parentId, NullSpaceIPC::PlaybackEvent::Command command) {
+NullSpaceIPC::HighLevelEvent makePlaybackEvent(uint64_t parentId, NullSpaceIPC::PlaybackEvent::Command command) {
 	using namespace NullSpaceIPC;
 	HighLevelEvent event;
 
-	event.set_parent_id(truncatedUuid(parentId));
+	event.set_parent_id(parentId);
 
 	PlaybackEvent* playback_event = event.mutable_playback_event();
 	playback_event->set_command(command);
@@ -219,21 +235,21 @@ NullSpaceIPC::HighLevelEvent makePlaybackEvent(const boost::uuids::uuid& parentI
 void PlayableEffect::scrubToBegin()
 {
 	m_time = 0;
-	m_lastExecutedEffect = m_effects.begin();
+	m_nextEvent = 0;
 }
 
 void PlayableEffect::reset()
 {
-	m_messenger.WriteEvent(makePlaybackEvent(m_id, NullSpaceIPC::PlaybackEvent_Command_CANCEL));
+	m_messenger->WriteEvent(makePlaybackEvent(m_id, NullSpaceIPC::PlaybackEvent_Command_CANCEL));
 }
 
 void PlayableEffect::pause()
 {
-	m_messenger.WriteEvent(makePlaybackEvent(m_id, NullSpaceIPC::PlaybackEvent_Command_PAUSE));
+	m_messenger->WriteEvent(makePlaybackEvent(m_id, NullSpaceIPC::PlaybackEvent_Command_PAUSE));
 }
 
 void PlayableEffect::resume() {
-	m_messenger.WriteEvent(makePlaybackEvent(m_id, NullSpaceIPC::PlaybackEvent_Command_UNPAUSE));
+	m_messenger->WriteEvent(makePlaybackEvent(m_id, NullSpaceIPC::PlaybackEvent_Command_UNPAUSE));
 }
 
 
@@ -1,14 +1,18 @@
 #pragma once
-#include "PlayableEvent.h"
+#include "EffectProgram.h"
 
-#include <boost/uuid/uuid.hpp>
 #include <vector>
+#include <string>
 #include <memory>
+#include <atomic>
+#include <chrono>
 
 
 //The purpose of this class is to hold a bunch of events together in a timeline - an Effect. 
 //This is the actual object that a user of the Hardlight SDK is interacting with when they make haptic effects.
 //It contains facilities for controlling playback of an effect, as well as releasing it when they are done. 
+//The events themselves belong to an EffectProgram, which any number of effects may share; each PlayableEffect
+//is one playback instance of its program, and only holds playback state.
 
 //Used to group together some common info about an effect, for use at higher levels of the SDK
 struct EffectInfo {
@@ -17,11 +21,21 @@ struct EffectInfo {
 	int State;
 };
 
+//Playback progress of an effect, published by the effect whenever it changes so that other threads
+//can read it without going through the player
+struct PlaybackStatus {
+	//Elapsed time when the effect last paused or stopped, in fractional seconds
+	std::atomic<float> CurrentTime;
+	//While playing, the player time (in microseconds) at which the effect would have started from the beginning
+	std::atomic<int64_t> StartedAt;
+	std::atomic<int> State;
+};
 
-using PlayablePtr = std::unique_ptr<PlayableEvent>;
+//Time on the player's clock, which advances by the timestep of each update
+using PlayerTime = std::chrono::microseconds;
 
-void sortByTime(std::vector<PlayablePtr>* playables);
-void removeDuplicates(std::vector<PlayablePtr>* playables);
+PlayerTime toPlayerTime(float seconds);
+float toSeconds(PlayerTime time);
 
 
 class ClientMessenger;
@@ -30,28 +44,48 @@ class PlayableEffect
 {
 public:
 
-	//Precondition: effects.size() > 0
-	PlayableEffect(std::vector<PlayablePtr> effects, boost::uuids::uuid id, ClientMessenger& messenger);
+	//The program is shared; the effect itself only holds playback state
+	PlayableEffect(std::shared_ptr<const EffectProgram> program, uint64_t id, ClientMessenger& messenger);
 
-	//Can't be copied - that would break the internal effect iterator 
+	//Can't be copied - effects are uniquely identified
 	PlayableEffect(const PlayableEffect&) = delete;
 
-	//But can be moved - will not break internal effect iterator
+	//But can be moved
 	PlayableEffect(PlayableEffect&&) = default;
+	PlayableEffect& operator=(PlayableEffect&&) = default;
+
+	//Playback is driven by the player's clock. The effect doesn't dispatch its own events; whoever owns it
+	//schedules the pending events when it starts playing, and calls Fire as each one comes due.
+	void Play(PlayerTime now);
+	void Pause(PlayerTime now);
+	void Stop(PlayerTime now);
+
+	//Sends the given event to the service
+	void Fire(std::size_t eventIndex);
+
+	//Index of the first event which hasn't fired yet during this playback
+	std::size_t NextEvent() const;
+	std::size_t EventCount() const;
 
-	void Play();
-	void Pause();
-	void Stop();
+	//When the given event is due on the player's clock. Only meaningful while playing.
+	PlayerTime EventDue(std::size_t eventIndex) const;
+	//When the effect is due to stop by itself on the player's clock. Only meaningful while playing.
+	PlayerTime EndDue() const;
 
-	void Update(float dt);
+	//Changes every time the effect starts playing, so that events scheduled for an earlier playback can be told apart
+	uint32_t Epoch() const;
 
 	float GetTotalDuration() const;
-	float CurrentTime() const;
+	float CurrentTime(PlayerTime now) const;
 	bool IsPlaying() const;
 	bool IsReleased() const;
 	void Release();
 
-	EffectInfo GetInfo() const;
+	static EffectInfo ReadInfo(const EffectMetadata& metadata, const PlaybackStatus& status, PlayerTime now);
+
+	std::shared_ptr<const EffectProgram> GetProgram() const;
+	std::shared_ptr<const EffectMetadata> GetMetadata() const;
+	std::shared_ptr<const PlaybackStatus> GetStatus() const;
 	
 private:
 	enum class PlaybackState {
@@ -61,13 +95,24 @@ private:
 	};
 
 	PlaybackState m_state;
-	float m_time;
-	std::vector<std::unique_ptr<PlayableEvent>> m_effects;
-	decltype(m_effects)::iterator m_lastExecutedEffect;
-	boost::uuids::uuid m_id;
-	ClientMessenger& m_messenger;
+	//Elapsed time as of the last pause or stop. While playing, elapsed time is derived from m_startedAt instead.
+	float m_time; 
+	PlayerTime m_startedAt;
+	uint32_t m_epoch;
+	std::shared_ptr<const EffectProgram> m_program;
+	std::size_t m_nextEvent;
+	//Identifies the effect to the service. Unique among the effects of an Engine.
+	uint64_t m_id;
+	//Wire encoding of the parent_id field, which is all that differs between this effect's events and another instance's
+	std::string m_encodedId;
+	//Pointer rather than reference so that effects can be move-assigned within their container
+	ClientMessenger* m_messenger;
 	bool m_isReleased;
 
+	std::shared_ptr<PlaybackStatus> m_status;
+
+	void publishStatus();
+
 
 
 	void scrubToBegin();
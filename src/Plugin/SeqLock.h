@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+//Publishes a value from one writer to any number of readers, without readers ever taking a lock or blocking the writer.
+//The writer makes the sequence odd while it writes and even again when it is done. A reader copies the value out
+//between two reads of the sequence, and retries unless both reads saw the same even number, so it never keeps a copy
+//which a write went through the middle of.
+//
+//The value is held as atomic words rather than as a T, so that a reader racing the writer is well defined: it may copy
+//a mix of old and new words, but then the sequence check fails and the copy is thrown away.
+//
+//Store must only be called by one thread at a time. Load may be called from any thread.
+template<typename T>
+class SeqLock {
+	static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied word by word");
+
+public:
+	SeqLock();
+	explicit SeqLock(const T& initial);
+
+	SeqLock(const SeqLock&) = delete;
+	SeqLock& operator=(const SeqLock&) = delete;
+
+	void Store(const T& value);
+	T Load() const;
+
+	//Number of completed stores. Readers can compare it against an earlier value to see whether anything changed.
+	uint64_t Version() const;
+
+private:
+	static const std::size_t num_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	std::atomic<uint64_t> m_sequence;
+	std::array<std::atomic<uint64_t>, num_words> m_words;
+};
+
+template<typename T>
+SeqLock<T>::SeqLock()
+	: SeqLock(T())
+{
+}
+
+template<typename T>
+SeqLock<T>::SeqLock(const T& initial)
+	: m_sequence(0)
+	, m_words()
+{
+	Store(initial);
+	m_sequence.store(0, std::memory_order_relaxed);
+}
+
+template<typename T>
+void SeqLock<T>::Store(const T& value)
+{
+	std::array<uint64_t, num_words> words = {};
+	std::memcpy(words.data(), &value, sizeof(T));
+
+	const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+	m_sequence.store(sequence + 1, std::memory_order_relaxed);
+	//Keeps the word stores below from being seen before the sequence goes odd
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (std::size_t i = 0; i < num_words; i++) {
+		m_words[i].store(words[i], std::memory_order_relaxed);
+	}
+
+	m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+template<typename T>
+T SeqLock<T>::Load() const
+{
+	std::array<uint64_t, num_words> words;
+	for (;;) {
+		const uint64_t before = m_sequence.load(std::memory_order_acquire);
+		if (before & 1) {
+			continue;
+		}
+
+		for (std::size_t i = 0; i < num_words; i++) {
+			words[i] = m_words[i].load(std::memory_order_relaxed);
+		}
+
+		//Keeps the word loads above from being seen after the second read of the sequence
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_sequence.load(std::memory_order_relaxed) == before) {
+			break;
+		}
+	}
+
+	T value;
+	std::memcpy(&value, words.data(), sizeof(T));
+	return value;
+}
+
+template<typename T>
+uint64_t SeqLock<T>::Version() const
+{
+	return m_sequence.load(std::memory_order_acquire) / 2;
+}
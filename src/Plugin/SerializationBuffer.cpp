@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "SerializationBuffer.h"
+
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include <algorithm>
+#include <cstring>
+
+using google::protobuf::uint8;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::internal::WireFormatLite;
+
+SerializationBuffer::SerializationBuffer(std::size_t initialCapacity)
+	: m_buffer(initialCapacity)
+	, m_size(0)
+{
+}
+
+std::size_t SerializationBuffer::Serialize(const google::protobuf::MessageLite& message)
+{
+	Clear();
+
+	//ByteSize() caches the size of every submessage, so SerializeWithCachedSizesToArray doesn't need to compute them again
+	const std::size_t size = static_cast<std::size_t>(message.ByteSize());
+	char* target = reserve(size);
+	message.SerializeWithCachedSizesToArray(reinterpret_cast<uint8*>(target));
+
+	m_size = size;
+	return m_size;
+}
+
+std::size_t SerializationBuffer::AppendField(uint32_t fieldNumber, const google::protobuf::MessageLite& message)
+{
+	const uint32_t tag = WireFormatLite::MakeTag(fieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+	const uint32_t messageSize = static_cast<uint32_t>(message.ByteSize());
+	const std::size_t fieldSize = CodedOutputStream::VarintSize32(tag) + CodedOutputStream::VarintSize32(messageSize) + messageSize;
+
+	uint8* target = reinterpret_cast<uint8*>(reserve(fieldSize));
+	target = CodedOutputStream::WriteTagToArray(tag, target);
+	target = CodedOutputStream::WriteVarint32ToArray(messageSize, target);
+	message.SerializeWithCachedSizesToArray(target);
+
+	m_size += fieldSize;
+	return m_size;
+}
+
+std::size_t SerializationBuffer::SerializeEncoded(EncodedBytes head, EncodedBytes tail)
+{
+	Clear();
+
+	char* target = reserve(head.size + tail.size);
+	std::memcpy(target, head.data, head.size);
+	std::memcpy(target + head.size, tail.data, tail.size);
+
+	m_size = head.size + tail.size;
+	return m_size;
+}
+
+std::size_t SerializationBuffer::AppendEncodedField(uint32_t fieldNumber, EncodedBytes head, EncodedBytes tail)
+{
+	const uint32_t tag = WireFormatLite::MakeTag(fieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+	const uint32_t messageSize = static_cast<uint32_t>(head.size + tail.size);
+	const std::size_t fieldSize = CodedOutputStream::VarintSize32(tag) + CodedOutputStream::VarintSize32(messageSize) + messageSize;
+
+	uint8* target = reinterpret_cast<uint8*>(reserve(fieldSize));
+	target = CodedOutputStream::WriteTagToArray(tag, target);
+	target = CodedOutputStream::WriteVarint32ToArray(messageSize, target);
+	std::memcpy(target, head.data, head.size);
+	std::memcpy(target + head.size, tail.data, tail.size);
+
+	m_size += fieldSize;
+	return m_size;
+}
+
+void SerializationBuffer::Clear()
+{
+	m_size = 0;
+}
+
+const char* SerializationBuffer::data() const
+{
+	return m_buffer.data();
+}
+
+std::size_t SerializationBuffer::size() const
+{
+	return m_size;
+}
+
+bool SerializationBuffer::empty() const
+{
+	return m_size == 0;
+}
+
+//Returns a pointer to at least additionalBytes of space past the current contents
+char* SerializationBuffer::reserve(std::size_t additionalBytes)
+{
+	const std::size_t required = m_size + additionalBytes;
+	if (m_buffer.size() < required) {
+		m_buffer.resize(std::max(required, m_buffer.size() * 2));
+	}
+	return m_buffer.data() + m_size;
+}
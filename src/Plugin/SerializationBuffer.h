@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace google {
+	namespace protobuf {
+		class MessageLite;
+	}
+}
+
+//A run of bytes which are already in protobuf wire format
+struct EncodedBytes {
+	const char* data;
+	std::size_t size;
+};
+
+//Scratch space for serializing protobuf messages. The buffer grows to fit the largest message it has seen and is then reused,
+//so that steady-state serialization doesn't touch the heap.
+//This class is not thread safe; synchronization must happen at a higher level
+class SerializationBuffer {
+public:
+	explicit SerializationBuffer(std::size_t initialCapacity);
+
+	//Serializes the message into the buffer, replacing any previous contents, and returns the number of bytes written.
+	//The bytes are valid until the next call to Serialize, AppendField, or Clear.
+	std::size_t Serialize(const google::protobuf::MessageLite& message);
+
+	//Appends the message as a length-delimited field. This is the encoding protobuf uses for each element of
+	//'repeated SomeMessage field = fieldNumber', so a run of appends can be parsed on the other side as one envelope message.
+	//Returns the total number of bytes in the buffer.
+	std::size_t AppendField(uint32_t fieldNumber, const google::protobuf::MessageLite& message);
+
+	//Same as Serialize and AppendField, but for a message which was encoded ahead of time. A message is just its fields
+	//laid end to end, so the message is given as two encoded pieces (e.g. a per-effect id field, and a precomputed body)
+	//which are copied in one after the other, without going through protobuf at all.
+	std::size_t SerializeEncoded(EncodedBytes head, EncodedBytes tail);
+	std::size_t AppendEncodedField(uint32_t fieldNumber, EncodedBytes head, EncodedBytes tail);
+
+	void Clear();
+
+	const char* data() const;
+	std::size_t size() const;
+	bool empty() const;
+
+private:
+	std::vector<char> m_buffer;
+	std::size_t m_size;
+
+	char* reserve(std::size_t additionalBytes);
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//A SlotMap stores values contiguously and hands out generation-checked handles to them.
+//
+//Values live in a dense vector, so iterating is a linear walk over memory. Each handle names a slot which 
+//records where its value currently sits in the dense vector, giving O(1) lookup, and removal is an O(1) swap with the last value.
+//
+//When a value is removed, its slot's generation is bumped. A handle carries the generation it was issued with,
+//so a stale handle never aliases a newer value that happens to reuse the same slot.
+//
+//Handles are never 0, so 0 can be used as an "empty" handle by callers.
+//This class is not thread safe; synchronization must happen at a higher level
+template<typename T>
+class SlotMap {
+public:
+	using Handle = uint32_t;
+	using iterator = typename std::vector<T>::iterator;
+	using const_iterator = typename std::vector<T>::const_iterator;
+
+	SlotMap();
+
+	Handle Insert(T value);
+
+	//Returns false if the handle is stale or was never issued
+	bool Erase(Handle handle);
+
+	T* Find(Handle handle);
+	const T* Find(Handle handle) const;
+
+	//Handle of the value at the given position of the dense storage
+	Handle HandleAt(std::size_t denseIndex) const;
+
+	void Clear();
+
+	//Which slot a handle names. Slots are numbered from 0, and there are never more than MaxSlots() of them.
+	static uint32_t SlotIndex(Handle handle) { return handle & index_mask; }
+	static constexpr uint32_t MaxSlots() { return no_free_slot; }
+
+	std::size_t size() const;
+	bool empty() const;
+
+	iterator begin() { return m_values.begin(); }
+	iterator end() { return m_values.end(); }
+	const_iterator begin() const { return m_values.begin(); }
+	const_iterator end() const { return m_values.end(); }
+	T& operator[](std::size_t denseIndex) { return m_values[denseIndex]; }
+	const T& operator[](std::size_t denseIndex) const { return m_values[denseIndex]; }
+
+private:
+	static const uint32_t index_bits = 20;
+	static const uint32_t index_mask = (1u << index_bits) - 1;
+	static const uint32_t generation_mask = (1u << (32 - index_bits)) - 1;
+	static const uint32_t no_free_slot = index_mask;
+
+	struct Slot {
+		//Position of the value in m_values while occupied; the next free slot while free
+		uint32_t denseIndex;
+		uint32_t generation;
+	};
+
+	std::vector<T> m_values;
+	std::vector<uint32_t> m_denseToSlot;
+	std::vector<Slot> m_slots;
+	uint32_t m_freeHead;
+
+	static Handle makeHandle(uint32_t slotIndex, uint32_t generation);
+	const Slot* findSlot(Handle handle) const;
+};
+
+template<typename T>
+SlotMap<T>::SlotMap()
+	: m_values()
+	, m_denseToSlot()
+	, m_slots()
+	, m_freeHead(no_free_slot)
+{
+}
+
+template<typename T>
+typename SlotMap<T>::Handle SlotMap<T>::Insert(T value)
+{
+	uint32_t slotIndex = m_freeHead;
+	if (slotIndex != no_free_slot) {
+		m_freeHead = m_slots[slotIndex].denseIndex;
+	}
+	else {
+		if (m_slots.size() >= no_free_slot) {
+			throw std::length_error("SlotMap is full");
+		}
+		slotIndex = static_cast<uint32_t>(m_slots.size());
+		m_slots.push_back(Slot{ 0, 1 });
+	}
+
+	Slot& slot = m_slots[slotIndex];
+	slot.denseIndex = static_cast<uint32_t>(m_values.size());
+	m_values.push_back(std::move(value));
+	m_denseToSlot.push_back(slotIndex);
+
+	return makeHandle(slotIndex, slot.generation);
+}
+
+template<typename T>
+bool SlotMap<T>::Erase(Handle handle)
+{
+	const Slot* found = findSlot(handle);
+	if (found == nullptr) {
+		return false;
+	}
+
+	const uint32_t slotIndex = handle & index_mask;
+	const uint32_t denseIndex = found->denseIndex;
+	const uint32_t lastIndex = static_cast<uint32_t>(m_values.size() - 1);
+
+	//Move the last value into the hole, and repoint its slot
+	if (denseIndex != lastIndex) {
+		m_values[denseIndex] = std::move(m_values[lastIndex]);
+		m_denseToSlot[denseIndex] = m_denseToSlot[lastIndex];
+		m_slots[m_denseToSlot[denseIndex]].denseIndex = denseIndex;
+	}
+	m_values.pop_back();
+	m_denseToSlot.pop_back();
+
+	Slot& slot = m_slots[slotIndex];
+	slot.generation = (slot.generation + 1) & generation_mask;
+	if (slot.generation == 0) {
+		slot.generation = 1;
+	}
+	slot.denseIndex = m_freeHead;
+	m_freeHead = slotIndex;
+	return true;
+}
+
+template<typename T>
+T* SlotMap<T>::Find(Handle handle)
+{
+	return const_cast<T*>(static_cast<const SlotMap<T>*>(this)->Find(handle));
+}
+
+template<typename T>
+const T* SlotMap<T>::Find(Handle handle) const
+{
+	if (const Slot* slot = findSlot(handle)) {
+		return &m_values[slot->denseIndex];
+	}
+	return nullptr;
+}
+
+template<typename T>
+typename SlotMap<T>::Handle SlotMap<T>::HandleAt(std::size_t denseIndex) const
+{
+	assert(denseIndex < m_values.size());
+	const uint32_t slotIndex = m_denseToSlot[denseIndex];
+	return makeHandle(slotIndex, m_slots[slotIndex].generation);
+}
+
+template<typename T>
+void SlotMap<T>::Clear()
+{
+	while (!m_values.empty()) {
+		Erase(HandleAt(m_values.size() - 1));
+	}
+}
+
+template<typename T>
+std::size_t SlotMap<T>::size() const
+{
+	return m_values.size();
+}
+
+template<typename T>
+bool SlotMap<T>::empty() const
+{
+	return m_values.empty();
+}
+
+template<typename T>
+typename SlotMap<T>::Handle SlotMap<T>::makeHandle(uint32_t slotIndex, uint32_t generation)
+{
+	return (generation << index_bits) | slotIndex;
+}
+
+template<typename T>
+const typename SlotMap<T>::Slot* SlotMap<T>::findSlot(Handle handle) const
+{
+	const uint32_t slotIndex = handle & index_mask;
+	const uint32_t generation = handle >> index_bits;
+	if (slotIndex >= m_slots.size()) {
+		return nullptr;
+	}
+
+	const Slot& slot = m_slots[slotIndex];
+
+	//A free slot's denseIndex is a free-list link, so also check that the dense entry points back at this slot
+	if (slot.generation != generation
+		|| slot.denseIndex >= m_values.size()
+		|| m_denseToSlot[slot.denseIndex] != slotIndex) {
+		return nullptr;
+	}
+
+	return &slot;
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//A hierarchical timer wheel: values are scheduled to fire at an absolute tick, and advancing the wheel
+//fires only the values which have come due.
+//
+//The lowest level has one slot per tick. Each level above has slots which are slots_per_level times as wide,
+//so a value far in the future sits in a coarse slot until the wheel gets close to it, and is then cascaded down
+//into a finer level. Scheduling is O(1), and advancing costs at most one slot visit per tick plus the values that 
+//fire or cascade, independent of how many values are waiting. Stretches where the finer levels are empty are skipped.
+//
+//Values which are scheduled together and come due on the same tick fire in the order they were scheduled.
+//
+//Values can't be removed individually. Callers are expected to tag values so that stale ones can be ignored
+//when they fire, and may sweep them out early with RemoveIf.
+//This class is not thread safe; synchronization must happen at a higher level
+template<typename T>
+class TimerWheel {
+public:
+	using Tick = uint64_t;
+
+	explicit TimerWheel(Tick now = 0);
+
+	//Values scheduled for the current tick or earlier fire on the next call to Advance
+	void Schedule(Tick due, T value);
+
+	//Moves the wheel forward to the given tick, calling fire(value) for everything which came due on the way.
+	//fire must not schedule new values.
+	template<typename Fn>
+	void Advance(Tick now, Fn&& fire);
+
+	//Drops every value for which pred(value) is true
+	template<typename Pred>
+	void RemoveIf(Pred&& pred);
+
+	void Clear();
+
+	Tick Now() const;
+	std::size_t size() const;
+	bool empty() const;
+
+private:
+	static const unsigned bits_per_level = 6;
+	static const Tick slots_per_level = Tick(1) << bits_per_level;
+	static const Tick slot_mask = slots_per_level - 1;
+	static const unsigned num_levels = 4;
+
+	struct Entry {
+		Tick due;
+		T value;
+	};
+
+	using Slot = std::vector<Entry>;
+
+	std::array<std::array<Slot, slots_per_level>, num_levels> m_levels;
+	std::array<std::size_t, num_levels> m_levelSizes;
+	Slot m_expired;
+	Tick m_now;
+	std::size_t m_size;
+
+	//Scratch space used while firing or cascading a slot, kept to avoid reallocating every tick
+	Slot m_firing;
+
+	void insert(Entry entry);
+	void cascade(unsigned level);
+	Tick nextInterestingTick() const;
+
+	template<typename Fn>
+	void fireAll(Slot& slot, Fn& fire);
+	static std::size_t slotIndex(Tick due, unsigned level);
+};
+
+template<typename T>
+TimerWheel<T>::TimerWheel(Tick now)
+	: m_levels()
+	, m_levelSizes()
+	, m_expired()
+	, m_now(now)
+	, m_size(0)
+	, m_firing()
+{
+}
+
+template<typename T>
+void TimerWheel<T>::Schedule(Tick due, T value)
+{
+	insert(Entry{ due, std::move(value) });
+	m_size++;
+}
+
+template<typename T>
+template<typename Fn>
+void TimerWheel<T>::Advance(Tick now, Fn&& fire)
+{
+	fireAll(m_expired, fire);
+
+	while (m_now < now) {
+		//Nothing left to fire, so there is no need to visit the slots in between
+		if (m_size == 0) {
+			m_now = now;
+			break;
+		}
+
+		m_now = std::min(now, nextInterestingTick());
+
+		//Whenever a level wraps around, the next slot of the level above is due to be spread out below it
+		for (unsigned level = 1; level < num_levels; level++) {
+			if ((m_now & ((Tick(1) << (bits_per_level * level)) - 1)) != 0) {
+				break;
+			}
+			cascade(level);
+		}
+
+		//Cascading can land values due on exactly this tick in m_expired
+		fireAll(m_expired, fire);
+
+		Slot& slot = m_levels[0][slotIndex(m_now, 0)];
+		m_levelSizes[0] -= slot.size();
+		fireAll(slot, fire);
+	}
+}
+
+template<typename T>
+template<typename Fn>
+void TimerWheel<T>::fireAll(Slot& slot, Fn& fire)
+{
+	if (slot.empty()) {
+		return;
+	}
+
+	m_firing.swap(slot);
+	for (Entry& entry : m_firing) {
+		m_size--;
+		fire(entry.value);
+	}
+	m_firing.clear();
+}
+
+template<typename T>
+template<typename Pred>
+void TimerWheel<T>::RemoveIf(Pred&& pred)
+{
+	auto removeFrom = [&](Slot& slot) {
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < slot.size(); i++) {
+			if (!pred(slot[i].value)) {
+				if (kept != i) {
+					slot[kept] = std::move(slot[i]);
+				}
+				kept++;
+			}
+		}
+		m_size -= slot.size() - kept;
+		slot.erase(slot.begin() + kept, slot.end());
+	};
+
+	removeFrom(m_expired);
+	for (unsigned level = 0; level < num_levels; level++) {
+		for (Slot& slot : m_levels[level]) {
+			std::size_t before = slot.size();
+			removeFrom(slot);
+			m_levelSizes[level] -= before - slot.size();
+		}
+	}
+}
+
+template<typename T>
+void TimerWheel<T>::Clear()
+{
+	m_expired.clear();
+	for (auto& level : m_levels) {
+		for (Slot& slot : level) {
+			slot.clear();
+		}
+	}
+	m_levelSizes.fill(0);
+	m_size = 0;
+}
+
+template<typename T>
+typename TimerWheel<T>::Tick TimerWheel<T>::Now() const
+{
+	return m_now;
+}
+
+template<typename T>
+std::size_t TimerWheel<T>::size() const
+{
+	return m_size;
+}
+
+template<typename T>
+bool TimerWheel<T>::empty() const
+{
+	return m_size == 0;
+}
+
+template<typename T>
+void TimerWheel<T>::insert(Entry entry)
+{
+	if (entry.due <= m_now) {
+		m_expired.push_back(std::move(entry));
+		return;
+	}
+
+	const Tick delta = entry.due - m_now;
+	for (unsigned level = 0; level < num_levels; level++) {
+		if (delta < (Tick(1) << (bits_per_level * (level + 1)))) {
+			m_levels[level][slotIndex(entry.due, level)].push_back(std::move(entry));
+			m_levelSizes[level]++;
+			return;
+		}
+	}
+
+	//Further out than the wheel spans. Park it in the slot of the top level which will be cascaded last;
+	//it gets re-inserted from there, and keeps moving down as the wheel catches up to it.
+	const unsigned top = num_levels - 1;
+	const Tick parked = m_now + (slot_mask << (bits_per_level * top));
+	m_levels[top][slotIndex(parked, top)].push_back(std::move(entry));
+	m_levelSizes[top]++;
+}
+
+template<typename T>
+void TimerWheel<T>::cascade(unsigned level)
+{
+	Slot& slot = m_levels[level][slotIndex(m_now, level)];
+	if (slot.empty()) {
+		return;
+	}
+
+	m_levelSizes[level] -= slot.size();
+	m_firing.swap(slot);
+	for (Entry& entry : m_firing) {
+		insert(std::move(entry));
+	}
+	m_firing.clear();
+}
+
+//The next tick on which anything could fire or cascade: the next tick if the lowest level has anything in it,
+//otherwise the next time the lowest occupied level wraps around
+template<typename T>
+typename TimerWheel<T>::Tick TimerWheel<T>::nextInterestingTick() const
+{
+	unsigned level = 0;
+	while (level < num_levels - 1 && m_levelSizes[level] == 0) {
+		level++;
+	}
+
+	const unsigned shift = bits_per_level * level;
+	return ((m_now >> shift) + 1) << shift;
+}
+
+template<typename T>
+std::size_t TimerWheel<T>::slotIndex(Tick due, unsigned level)
+{
+	return static_cast<std::size_t>((due >> (bits_per_level * level)) & slot_mask);
+}
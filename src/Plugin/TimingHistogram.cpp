@@ -0,0 +1,134 @@
+#include "stdafx.h"
+#include "TimingHistogram.h"
+
+#include <cmath>
+
+TimingHistogram::TimingHistogram()
+	: m_buckets()
+	, m_fineBuckets()
+	, m_count(0)
+	, m_totalNanos(0)
+	, m_maxNanos(0)
+{
+	for (auto& bucket : m_buckets) {
+		bucket.store(0);
+	}
+	for (auto& bucket : m_fineBuckets) {
+		bucket.store(0);
+	}
+}
+
+void TimingHistogram::Record(std::chrono::nanoseconds error)
+{
+	m_buckets[BucketFor(error)].fetch_add(1, std::memory_order_relaxed);
+	m_fineBuckets[fineBucketFor(error)].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_totalNanos.fetch_add(error.count(), std::memory_order_relaxed);
+
+	//Only one thread records, so a plain compare is enough
+	if (error.count() > m_maxNanos.load(std::memory_order_relaxed)) {
+		m_maxNanos.store(error.count(), std::memory_order_relaxed);
+	}
+}
+
+uint64_t TimingHistogram::Count() const
+{
+	return m_count.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds TimingHistogram::Max() const
+{
+	return std::chrono::nanoseconds(m_maxNanos.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds TimingHistogram::Mean() const
+{
+	uint64_t count = Count();
+	if (count == 0) {
+		return std::chrono::nanoseconds(0);
+	}
+
+	return std::chrono::nanoseconds(m_totalNanos.load(std::memory_order_relaxed) / static_cast<int64_t>(count));
+}
+
+std::array<uint64_t, TimingHistogram::num_buckets> TimingHistogram::Buckets() const
+{
+	std::array<uint64_t, num_buckets> buckets;
+	for (std::size_t i = 0; i < num_buckets; i++) {
+		buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+	}
+	return buckets;
+}
+
+std::size_t TimingHistogram::BucketFor(std::chrono::nanoseconds error)
+{
+	const std::chrono::nanoseconds first_bucket = std::chrono::microseconds(125);
+
+	std::size_t bucket = 0;
+	std::chrono::nanoseconds upperBound = first_bucket;
+	while (bucket < num_buckets - 1 && error >= upperBound) {
+		bucket++;
+		upperBound *= 2;
+	}
+	return bucket;
+}
+
+std::chrono::nanoseconds TimingHistogram::Percentile(double fraction) const
+{
+	uint64_t count = 0;
+	std::array<uint64_t, num_fine_buckets> buckets;
+	for (std::size_t i = 0; i < num_fine_buckets; i++) {
+		buckets[i] = m_fineBuckets[i].load(std::memory_order_relaxed);
+		count += buckets[i];
+	}
+
+	if (count == 0) {
+		return std::chrono::nanoseconds(0);
+	}
+
+	//The rank of the sample we are after, counting from 1
+	const double clamped = std::min(1.0, std::max(0.0, fraction));
+	const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * count)));
+
+	uint64_t seen = 0;
+	for (std::size_t i = 0; i < num_fine_buckets; i++) {
+		seen += buckets[i];
+		if (seen >= rank) {
+			return std::min(fineBucketUpperBound(i), Max());
+		}
+	}
+
+	return Max();
+}
+
+//Buckets 0 to 7 are one microsecond wide. After that, every power of two is split into eight.
+std::size_t TimingHistogram::fineBucketFor(std::chrono::nanoseconds error)
+{
+	if (error.count() <= 0) {
+		return 0;
+	}
+
+	const uint64_t micros = static_cast<uint64_t>(error.count()) / 1000;
+	if (micros < 8) {
+		return static_cast<std::size_t>(micros);
+	}
+
+	std::size_t log2 = 3;
+	while ((micros >> (log2 + 1)) != 0) {
+		log2++;
+	}
+
+	const std::size_t step = static_cast<std::size_t>((micros >> (log2 - 3)) & 7);
+	return std::min(num_fine_buckets - 1, (log2 - 2) * 8 + step);
+}
+
+std::chrono::nanoseconds TimingHistogram::fineBucketUpperBound(std::size_t bucket)
+{
+	if (bucket < 8) {
+		return std::chrono::microseconds(bucket + 1);
+	}
+
+	const std::size_t log2 = bucket / 8 + 2;
+	const uint64_t step = bucket % 8;
+	return std::chrono::microseconds((9 + step) << (log2 - 3));
+}
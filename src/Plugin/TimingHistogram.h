@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//Counts timing errors into power-of-two buckets. Bucket 0 holds errors under 125us (including early ones), 
+//bucket i holds errors in [125us * 2^(i-1), 125us * 2^i), and the last bucket holds everything from 16ms up.
+//
+//Alongside those, errors are counted at a finer grain (1us steps up to 8us, then eight steps per power of two, so
+//within 12.5%) for estimating percentiles.
+//
+//Recording is meant to happen on one thread (the haptics tick) while other threads read, so every counter is atomic.
+//A reader may see a tick counted in one field before another, but never a torn value.
+class TimingHistogram {
+public:
+	static const std::size_t num_buckets = 9;
+
+	TimingHistogram();
+
+	void Record(std::chrono::nanoseconds error);
+
+	uint64_t Count() const;
+	std::chrono::nanoseconds Max() const;
+	std::chrono::nanoseconds Mean() const;
+	std::array<uint64_t, num_buckets> Buckets() const;
+
+	//Estimates the error below which the given fraction (0 to 1) of recorded errors fall. 
+	//Rounds up to the edge of a fine bucket, but never past Max().
+	std::chrono::nanoseconds Percentile(double fraction) const;
+
+	static std::size_t BucketFor(std::chrono::nanoseconds error);
+private:
+	//Enough fine buckets to reach past 60ms
+	static const std::size_t num_fine_buckets = 112;
+
+	std::array<std::atomic<uint64_t>, num_buckets> m_buckets;
+	std::array<std::atomic<uint64_t>, num_fine_buckets> m_fineBuckets;
+	std::atomic<uint64_t> m_count;
+	std::atomic<int64_t> m_totalNanos;
+	std::atomic<int64_t> m_maxNanos;
+
+	static std::size_t fineBucketFor(std::chrono::nanoseconds error);
+	static std::chrono::nanoseconds fineBucketUpperBound(std::size_t bucket);
+};
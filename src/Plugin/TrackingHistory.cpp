@@ -0,0 +1,151 @@
+#include "stdafx.h"
+#include "TrackingHistory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using NullSpace::SharedMemory::Quaternion;
+
+//Predicting further than this from a single angular velocity overshoots more than it helps
+const std::chrono::milliseconds max_extrapolation(50);
+const float max_extrapolated_intervals = 2.0f;
+
+//Above this cosine, the angle between two orientations is too small for slerp's division by sin(angle) to be precise.
+//A normalized lerp is indistinguishable there anyway.
+const float slerp_threshold = 0.9995f;
+
+static float dot(const Quaternion& a, const Quaternion& b) {
+	return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//Spherical interpolation from a (t = 0) to b (t = 1) along the shorter arc. Past 1, it keeps rotating at the same rate.
+static Quaternion slerp(const Quaternion& a, Quaternion b, float t) {
+	float cosAngle = dot(a, b);
+
+	//q and -q are the same orientation; flipping b keeps us on the shorter arc
+	if (cosAngle < 0.0f) {
+		b.w = -b.w;
+		b.x = -b.x;
+		b.y = -b.y;
+		b.z = -b.z;
+		cosAngle = -cosAngle;
+	}
+
+	float weightA = 1.0f - t;
+	float weightB = t;
+	if (cosAngle < slerp_threshold) {
+		const float angle = std::acos(cosAngle);
+		const float sinAngle = std::sin(angle);
+		weightA = std::sin((1.0f - t) * angle) / sinAngle;
+		weightB = std::sin(t * angle) / sinAngle;
+	}
+
+	Quaternion result;
+	result.w = weightA * a.w + weightB * b.w;
+	result.x = weightA * a.x + weightB * b.x;
+	result.y = weightA * a.y + weightB * b.y;
+	result.z = weightA * a.z + weightB * b.z;
+
+	const float length = std::sqrt(dot(result, result));
+	if (length > 0.0f) {
+		result.w /= length;
+		result.x /= length;
+		result.y /= length;
+		result.z /= length;
+	}
+	return result;
+}
+
+static float ratio(TrackingHistory::Clock::duration part, TrackingHistory::Clock::duration whole) {
+	return std::chrono::duration<float>(part).count() / std::chrono::duration<float>(whole).count();
+}
+
+TrackingHistory::TrackingHistory()
+	: m_lock()
+	, m_regions()
+{
+}
+
+void TrackingHistory::Record(const TrackingSnapshot& snapshot, Clock::time_point at)
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	for (std::size_t i = 0; i < num_well_known_regions; i++) {
+		if (!(snapshot.Present & (RegionMask(1) << i))) {
+			continue;
+		}
+
+		Ring& ring = m_regions[i];
+		const Quaternion& orientation = snapshot.Regions[i].quat;
+		if (ring.Count > 0) {
+			const Sample& newest = ring.FromNewest(0);
+			//An unchanged region would otherwise add a flat step to the history, which is the judder we're avoiding
+			if (at <= newest.At || std::memcmp(&newest.Orientation, &orientation, sizeof(Quaternion)) == 0) {
+				continue;
+			}
+		}
+
+		ring.Push(Sample{ at, orientation });
+	}
+}
+
+boost::optional<Quaternion> TrackingHistory::OrientationAt(uint32_t region, Clock::time_point at) const
+{
+	const std::size_t index = regionIndex(region);
+	if (index >= num_well_known_regions) {
+		return boost::none;
+	}
+
+	std::lock_guard<std::mutex> guard(m_lock);
+	const Ring& ring = m_regions[index];
+	if (ring.Count == 0) {
+		return boost::none;
+	}
+
+	const Sample& newest = ring.FromNewest(0);
+	if (at >= newest.At) {
+		if (ring.Count == 1) {
+			return newest.Orientation;
+		}
+
+		const Sample& previous = ring.FromNewest(1);
+		const Clock::duration interval = newest.At - previous.At;
+		const Clock::duration horizon = std::min<Clock::duration>(max_extrapolation,
+			std::chrono::duration_cast<Clock::duration>(interval * max_extrapolated_intervals));
+		const Clock::duration ahead = std::min<Clock::duration>(at - newest.At, horizon);
+		return slerp(previous.Orientation, newest.Orientation, 1.0f + ratio(ahead, interval));
+	}
+
+	for (std::size_t age = 1; age < ring.Count; age++) {
+		const Sample& older = ring.FromNewest(age);
+		if (older.At <= at) {
+			const Sample& newer = ring.FromNewest(age - 1);
+			return slerp(older.Orientation, newer.Orientation, ratio(at - older.At, newer.At - older.At));
+		}
+	}
+
+	return ring.FromNewest(ring.Count - 1).Orientation;
+}
+
+void TrackingHistory::Clear()
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	for (Ring& ring : m_regions) {
+		ring.Next = 0;
+		ring.Count = 0;
+	}
+}
+
+const TrackingHistory::Sample& TrackingHistory::Ring::FromNewest(std::size_t age) const
+{
+	return Samples[(Next + samples_per_region - 1 - age) % samples_per_region];
+}
+
+void TrackingHistory::Ring::Push(const Sample& sample)
+{
+	Samples[Next] = sample;
+	Next = (Next + 1) % samples_per_region;
+	if (Count < samples_per_region) {
+		Count++;
+	}
+}
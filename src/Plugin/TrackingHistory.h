@@ -0,0 +1,57 @@
+#pragma once
+
+#include "TrackingSnapshot.h"
+
+#include <boost/optional.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+//The last few orientations of each tracked region, each with the time it was seen, so that a region can be asked
+//where it was (or is about to be) at any moment, rather than only at the moments the suit happened to report.
+//Games render at their own rate, which rarely lines up with the suit's, so showing the latest sample every frame judders.
+//
+//Between two samples the orientation is slerped. Past the newest, it carries on at the angular velocity of the last two
+//samples, but no further than 50ms or two sample intervals ahead; after that it holds. Before the oldest sample kept,
+//the oldest is returned.
+//
+//Record and OrientationAt may be called from any thread.
+class TrackingHistory {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	//Over 100ms at the rates the suit reports at
+	static const std::size_t samples_per_region = 16;
+
+	TrackingHistory();
+
+	//Adds a sample for each region in the snapshot whose orientation changed since its last one.
+	//Samples no newer than a region's last one are ignored, so time only ever moves forward.
+	void Record(const TrackingSnapshot& snapshot, Clock::time_point at);
+
+	//None if the region has never been seen. Only well known regions have a history.
+	boost::optional<NullSpace::SharedMemory::Quaternion> OrientationAt(uint32_t region, Clock::time_point at) const;
+
+	void Clear();
+
+private:
+	struct Sample {
+		Clock::time_point At;
+		NullSpace::SharedMemory::Quaternion Orientation;
+	};
+
+	struct Ring {
+		std::array<Sample, samples_per_region> Samples;
+		//Where the next sample goes, overwriting the oldest once the ring is full
+		std::size_t Next;
+		std::size_t Count;
+
+		//0 is the newest sample
+		const Sample& FromNewest(std::size_t age) const;
+		void Push(const Sample& sample);
+	};
+
+	mutable std::mutex m_lock;
+	std::array<Ring, num_well_known_regions> m_regions;
+};
@@ -0,0 +1,65 @@
+#include "stdafx.h"
+#include "TrackingNotifier.h"
+
+
+TrackingNotifier::TrackingNotifier(boost::asio::io_service& io, Latest latest)
+	: m_io(io)
+	, m_latest(std::move(latest))
+	, m_callbackLock()
+	, m_callback()
+	, m_lastDelivered(0)
+	, m_subscribed(false)
+	, m_deliveryQueued(false)
+{
+}
+
+void TrackingNotifier::Subscribe(Callback callback)
+{
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_callbackLock);
+		m_callback = std::move(callback);
+		m_lastDelivered = 0;
+		m_subscribed.store(static_cast<bool>(m_callback));
+	}
+
+	Notify();
+}
+
+void TrackingNotifier::Unsubscribe()
+{
+	std::lock_guard<std::recursive_mutex> guard(m_callbackLock);
+	m_callback = nullptr;
+	m_subscribed.store(false);
+}
+
+void TrackingNotifier::Notify()
+{
+	if (!m_subscribed.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	if (!m_deliveryQueued.exchange(true)) {
+		m_io.post([this]() { deliver(); });
+	}
+}
+
+void TrackingNotifier::deliver()
+{
+	//Cleared before reading the snapshot, so that a change from here on queues another delivery instead of being missed
+	m_deliveryQueued.store(false);
+
+	std::lock_guard<std::recursive_mutex> guard(m_callbackLock);
+	if (!m_callback) {
+		return;
+	}
+
+	auto snapshot = m_latest();
+	if (!snapshot || snapshot->Sequence == m_lastDelivered) {
+		return;
+	}
+	m_lastDelivered = snapshot->Sequence;
+
+	//The callback may unsubscribe, which would otherwise destroy it while it runs
+	Callback callback = m_callback;
+	callback(*snapshot);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "TrackingSnapshot.h"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+//Calls a subscriber back whenever tracking changes, so that games don't have to poll for it every frame.
+//
+//Whoever notices the change (usually a tracking refresh) only calls Notify, which never blocks and never runs the callback
+//itself. The callback runs later on the io_service, with whatever snapshot is newest by then. At most one delivery is queued
+//at a time, so changes which arrive while the callback is busy are coalesced into a single later call rather than
+//piling up behind it.
+//
+//The callback is game code, and may take as long as it likes, so the io_service shouldn't run anything else which
+//matters (see IoService::GetCallbackService).
+class TrackingNotifier {
+public:
+	using Callback = std::function<void(const TrackingSnapshot&)>;
+	//Reads the newest snapshot, or none if there isn't one
+	using Latest = std::function<boost::optional<TrackingSnapshot>()>;
+
+	TrackingNotifier(boost::asio::io_service& io, Latest latest);
+
+	TrackingNotifier(const TrackingNotifier&) = delete;
+	TrackingNotifier& operator=(const TrackingNotifier&) = delete;
+
+	//Replaces any previous callback. The new one is called with the current snapshot straight away, if there is one.
+	void Subscribe(Callback callback);
+
+	//Once this returns, the callback won't be called again. Waits for a call which is already running, unless it's
+	//called from within the callback itself.
+	void Unsubscribe();
+
+	//May be called from any thread
+	void Notify();
+
+private:
+	boost::asio::io_service& m_io;
+	Latest m_latest;
+
+	//Held while the callback runs, so that Unsubscribe can wait it out
+	std::recursive_mutex m_callbackLock;
+	Callback m_callback;
+	uint64_t m_lastDelivered;
+
+	//Lets Notify skip the io_service entirely when nobody is listening
+	std::atomic<bool> m_subscribed;
+	std::atomic<bool> m_deliveryQueued;
+
+	void deliver();
+};
@@ -0,0 +1,58 @@
+#include "stdafx.h"
+#include "TrackingSamples.h"
+
+static_assert(num_well_known_regions + TrackingSnapshot::max_other_regions <= HLVR_MAX_TRACKING_SAMPLES, "A snapshot must fit in the largest buffer callers need");
+
+void copyQuaternion(HLVR_Quaternion& lhs, const NullSpace::SharedMemory::Quaternion& rhs) {
+	lhs.w = rhs.w;
+	lhs.x = rhs.x;
+	lhs.y = rhs.y;
+	lhs.z = rhs.z;
+}
+
+void copyVector3f(HLVR_Vector3f& lhs, const NullSpace::SharedMemory::Vector3& rhs) {
+	lhs.x = rhs.x;
+	lhs.y = rhs.y;
+	lhs.z = rhs.z;
+}
+
+static void copyTrackingSample(HLVR_TrackingSample& sample, uint32_t region, const NullSpace::SharedMemory::TrackingData& data)
+{
+	sample.Region = region;
+	copyQuaternion(sample.Orientation, data.quat);
+	copyVector3f(sample.Compass, data.compass);
+	copyVector3f(sample.Gravity, data.gravity);
+}
+
+uint32_t copyTrackingSamples(const TrackingSnapshot& snapshot, HLVR_TrackingSample* outSamples)
+{
+	HLVR_TrackingSample* sample = outSamples;
+	forEachRegion(snapshot.Present, [&](uint32_t region) {
+		copyTrackingSample(*sample++, region, *snapshot.Find(region));
+	});
+	for (uint32_t i = 0; i < snapshot.OtherCount; i++) {
+		copyTrackingSample(*sample++, snapshot.Others[i].region, snapshot.Others[i]);
+	}
+	return static_cast<uint32_t>(sample - outSamples);
+}
+
+int readAllTracking(const boost::optional<TrackingSnapshot>& snapshot, HLVR_TrackingSample* outSamples, uint32_t capacity, uint32_t* outCount, uint64_t* inOutSequence)
+{
+	if (!snapshot) {
+		return HLVR_Error_NotConnected;
+	}
+
+	if (snapshot->Sequence == *inOutSequence) {
+		return HLVR_Ok_NoDataAvailable;
+	}
+
+	const uint32_t count = static_cast<uint32_t>(snapshot->Count());
+	if (count > capacity) {
+		*outCount = count;
+		return HLVR_Error_InvalidArgument;
+	}
+
+	*outCount = copyTrackingSamples(*snapshot, outSamples);
+	*inOutSequence = snapshot->Sequence;
+	return HLVR_Ok;
+}
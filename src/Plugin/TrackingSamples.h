@@ -0,0 +1,20 @@
+#pragma once
+
+#include "TrackingSnapshot.h"
+#include "HLVR_Experimental.h"
+
+#include <boost/optional.hpp>
+#include <cstdint>
+
+//Converts tracking from the service's types into the ones handed to games.
+
+void copyQuaternion(HLVR_Quaternion& lhs, const NullSpace::SharedMemory::Quaternion& rhs);
+
+void copyVector3f(HLVR_Vector3f& lhs, const NullSpace::SharedMemory::Vector3& rhs);
+
+//Writes one sample per tracked region, and returns how many. There are never more than HLVR_MAX_TRACKING_SAMPLES.
+uint32_t copyTrackingSamples(const TrackingSnapshot& snapshot, HLVR_TrackingSample* outSamples);
+
+//Does the work of HLVR_System_Tracking_GetAll, given the newest snapshot, or none if there isn't one.
+//See HLVR_Experimental.h for what each result means.
+int readAllTracking(const boost::optional<TrackingSnapshot>& snapshot, HLVR_TrackingSample* outSamples, uint32_t capacity, uint32_t* outCount, uint64_t* inOutSequence);
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "SharedTypes.h"
+#include "RegionMask.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+//Every tracked region as of one read of the service's tracking data. Well known regions are indexed by region so that
+//lookups are O(1); the few others a service might report are kept in a short list which is searched.
+//Snapshots are plain data, so they can be published to any number of readers through a SeqLock.
+struct TrackingSnapshot {
+	//Regions outside well_known_regions past this many are left out, and Truncated is set
+	static const std::size_t max_other_regions = 8;
+
+	//Changes whenever the tracking data does, so that readers can tell whether anything is new
+	uint64_t Sequence;
+	//Which of the well known regions are present
+	RegionMask Present;
+	std::array<NullSpace::SharedMemory::TrackingData, num_well_known_regions> Regions;
+	//Any other regions, in the order they were read
+	uint32_t OtherCount;
+	std::array<NullSpace::SharedMemory::TrackingData, max_other_regions> Others;
+	//Whether any regions were left out for lack of room. They can only be found in the data the snapshot was made from.
+	bool Truncated;
+
+	TrackingSnapshot() : Sequence(0), Present(0), Regions(), OtherCount(0), Others(), Truncated(false) {}
+
+	//Indexes the tracking data in a single pass. If a region appears more than once, the first entry wins,
+	//which is what searching the shared vector would have found.
+	TrackingSnapshot(uint64_t sequence, const std::vector<NullSpace::SharedMemory::TrackingData>& data)
+		: Sequence(sequence)
+		, Present(0)
+		, Regions()
+		, OtherCount(0)
+		, Others()
+		, Truncated(false)
+	{
+		for (const auto& tracked : data) {
+			const std::size_t index = regionIndex(tracked.region);
+			if (index < num_well_known_regions) {
+				if (!(Present & (RegionMask(1) << index))) {
+					Present |= RegionMask(1) << index;
+					Regions[index] = tracked;
+				}
+			}
+			else if (findOther(tracked.region) == nullptr) {
+				if (OtherCount < max_other_regions) {
+					Others[OtherCount++] = tracked;
+				}
+				else {
+					Truncated = true;
+				}
+			}
+		}
+	}
+
+	//Returns null if the region isn't tracked
+	const NullSpace::SharedMemory::TrackingData* Find(uint32_t region) const {
+		const std::size_t index = regionIndex(region);
+		if (index >= num_well_known_regions) {
+			return findOther(region);
+		}
+		if (!(Present & (RegionMask(1) << index))) {
+			return nullptr;
+		}
+		return &Regions[index];
+	}
+
+	//Number of tracked regions in the snapshot, well known or not
+	std::size_t Count() const {
+		std::size_t count = OtherCount;
+		for (RegionMask mask = Present; mask != 0; mask &= mask - 1) {
+			count++;
+		}
+		return count;
+	}
+
+private:
+	const NullSpace::SharedMemory::TrackingData* findOther(uint32_t region) const {
+		for (uint32_t i = 0; i < OtherCount; i++) {
+			if (Others[i].region == region) {
+				return &Others[i];
+			}
+		}
+		return nullptr;
+	}
+};
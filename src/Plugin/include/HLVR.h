@@ -314,7 +314,7 @@ extern "C" {
 		observed in a previous enumeration.
 
 		@note The struct must be initialized with HLVR_DeviceIterator_Init.
-		@note This struct can be declared on the stack. 
+		@note This struct can be declared on the stack. To stop before the end of an enumeration, see HLVR_DeviceIterator_Destroy.
 
 		@see HLVR_DeviceIterator_Init
 		@see HLVR_DeviceIterator_Next
@@ -334,7 +334,7 @@ extern "C" {
 		observed in a previous enumeration.
 
 		@note The struct must be initialized with HLVR_NodeIterator_Init.
-		@note This struct has no associated Destroy call and can be declared on the stack.
+		@note This struct can be declared on the stack. To stop before the end of an enumeration, see HLVR_NodeIterator_Destroy.
 
 		@see HLVR_NodeIterator_Init
 		@see HLVR_NodeIterator_Next
@@ -495,7 +495,8 @@ extern "C" {
 			@endcode
 		@param iter target iterator
 		@param system current context
-		@return HLVR_Ok if a device was retrieved, HLVR_Error_NoMoreDevices if the iterator is finished.
+		@return HLVR_Ok if a device was retrieved, HLVR_Error_NoMoreDevices if the iterator is finished,
+			HLVR_Error_NoSuchHandle if the iterator was abandoned for long enough to be reclaimed.
 	*/
 	HLVR_RETURN(HLVR_Result) HLVR_DeviceIterator_Next(HLVR_DeviceIterator* iter, HLVR_System* system);
 
@@ -551,6 +552,7 @@ extern "C" {
 			- HLVR_Ok if a node was retrieved
 			- HLVR_Error_NoMoreNodes if the iterator is finished.
 			- HLVR_Error_NoMoreNodes if an unknown @p device_id is supplied
+			- HLVR_Error_NoSuchHandle if the iterator was abandoned for long enough to be reclaimed
 	*/
 	HLVR_RETURN(HLVR_Result) HLVR_NodeIterator_Next(HLVR_NodeIterator* iter, uint32_t device_id, HLVR_System* system);
 
@@ -728,7 +730,11 @@ extern "C" {
 	*/
 	HLVR_RETURN(HLVR_Result) HLVR_Effect_Reset(HLVR_Effect* handle);
 	/*! Return information associated with this effect.
-		@return HLVR_Ok on success, else HLVR_Error_NoSuchHandle if the effect was destroyed or not yet bound
+		Play, Pause and Reset are queued for the haptics thread rather than applied straight away, so until it next runs
+		(within one haptics tick) the info may still show the state from before them.
+		Transmitting a timeline into an effect which already holds one releases the old one straight away: from then on only
+		the new one can be queried, even though the old one may still be playing out.
+		@return HLVR_Ok on success, HLVR_Error_NoSuchHandle if what it held has since been released, or HLVR_Error_EmptyHandle if it was never bound
 	*/
 	HLVR_RETURN(HLVR_Result) HLVR_Effect_GetInfo(const HLVR_Effect* effect, HLVR_EffectInfo* info);
 
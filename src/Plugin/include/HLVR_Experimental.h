@@ -84,6 +84,57 @@ extern "C" {
 	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetOrientation(HLVR_System* ptr, uint32_t region, HLVR_Quaternion* outOrientation);
 	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetCompass(HLVR_System* ptr, uint32_t region, HLVR_Vector3f* outCompass);
 	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetGravity(HLVR_System* ptr, uint32_t region, HLVR_Vector3f* outGravity);
+
+	/*! A snapshot never holds more samples than this, so a buffer this large is always enough */
+	#define HLVR_MAX_TRACKING_SAMPLES 40
+
+	typedef struct HLVR_TrackingSample {
+		uint32_t Region;
+		HLVR_Quaternion Orientation;
+		HLVR_Vector3f Compass;
+		HLVR_Vector3f Gravity;
+	} HLVR_TrackingSample;
+
+	/*! Read the orientation, compass and gravity of every tracked region at once, all from the same snapshot.
+		Only the first 8 regions outside HLVR_Region's values are included. Any further ones can still be read one 
+		at a time, with HLVR_System_Tracking_GetOrientation and the like.
+		@param outSamples receives one sample per tracked region. May be NULL if capacity is 0.
+		@param outCount receives the number of samples written
+		@param inOutSequence the sequence number returned by the previous call, or 0. Receives the sequence of this snapshot.
+		@return HLVR_Ok_NoDataAvailable if nothing changed since *inOutSequence, in which case nothing is written at all.
+			HLVR_Error_InvalidArgument if capacity is too small; *outCount then receives the capacity needed.
+			HLVR_Error_NotConnected if not connected to the service.
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetAll(HLVR_System* ptr, HLVR_TrackingSample* outSamples, uint32_t capacity, uint32_t* outCount, uint64_t* inOutSequence);
+
+	/*! Read the clock which tracking samples are timestamped with, in microseconds. Only differences between readings mean anything. */
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetTime(HLVR_System* ptr, uint64_t* outMicroseconds);
+
+	/*! Read the orientation of a region at a given time, blended from its recent samples, to avoid the judder of showing 
+		the latest sample on every frame. Between samples the orientation is interpolated. After the newest sample it is
+		extrapolated for up to 50ms (or two sample intervals, if shorter), then held. Before the oldest sample kept, the oldest is used.
+		@param timestampMicroseconds a time on the clock read by HLVR_System_Tracking_GetTime, such as the time a frame will be displayed
+		@return HLVR_Error_TrackedRegionNotFound if the region hasn't been tracked since connecting to the service, or isn't one of HLVR_Region's values
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_GetOrientationAt(HLVR_System* ptr, uint32_t region, uint64_t timestampMicroseconds, HLVR_Quaternion* outOrientation);
+
+	/*! Receives every tracked region whenever tracking changes, as HLVR_System_Tracking_GetAll would return it.
+		It is called from a plugin thread dedicated to callbacks, never from the game's. While it runs, further changes are coalesced, and the next call 
+		brings only the newest data, so a slow callback sees fewer updates rather than older ones. Even so, keep it short.
+		@param samples only valid for the duration of the call
+	*/
+	typedef void(*HLVR_TrackingCallback)(const HLVR_TrackingSample* samples, uint32_t count, uint64_t sequence, void* userData);
+
+	/*! Call back whenever tracking changes, instead of polling for it. Replaces any previous callback. 
+		The callback is called with the current tracking straight away, if there is any.
+		@param userData passed back to the callback untouched
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Subscribe(HLVR_System* ptr, HLVR_TrackingCallback callback, void* userData);
+
+	/*! Stop calling back. Once this returns, the callback will not be called again; if it is running on another thread, 
+		this waits for it to finish. May be called from within the callback itself.
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Unsubscribe(HLVR_System* ptr);
 	
 	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Enable(HLVR_System* ptr, uint32_t device_id);
 	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_Tracking_Disable(HLVR_System* ptr, uint32_t device_id);
@@ -91,6 +142,125 @@ extern "C" {
 
 	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_PushEvent(HLVR_System* system, HLVR_Event* data);
 
+
+	/*! Release an iterator's snapshot without finishing the enumeration. Iterators which reach the end release it themselves.
+		Abandoned iterators are reclaimed eventually: at most 64 of each kind are kept, and starting another past that reclaims 
+		the oldest, whose next call then returns HLVR_Error_NoSuchHandle.
+		@note The iterator must be initialized again with HLVR_DeviceIterator_Init before reuse.
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_DeviceIterator_Destroy(HLVR_DeviceIterator* iter, HLVR_System* system);
+
+	/*! Release an iterator's snapshot and start over: the next call to HLVR_DeviceIterator_Next enumerates the devices as they are then. */
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_DeviceIterator_Reset(HLVR_DeviceIterator* iter, HLVR_System* system);
+
+	/*! As HLVR_DeviceIterator_Destroy, for nodes */
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_NodeIterator_Destroy(HLVR_NodeIterator* iter, HLVR_System* system);
+
+	/*! As HLVR_DeviceIterator_Reset, for nodes */
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_NodeIterator_Reset(HLVR_NodeIterator* iter, HLVR_System* system);
+
+
+	/*! Set how often the system updates haptic effects, in milliseconds. Must be between 1 and 20; the default is 5.
+		Shorter intervals give more precise event timing at the cost of more CPU time.
+		@return HLVR_Error_InvalidArgument if the interval is out of range
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_SetHapticsTickInterval(HLVR_System* system, uint32_t milliseconds);
+
+
+	#define HLVR_TIMING_HISTOGRAM_BUCKETS 9
+
+	/*! Timing of the haptics update loop since the system was created.
+		Histogram bucket 0 counts errors under 0.125ms, bucket i counts errors in [0.125ms * 2^(i-1), 0.125ms * 2^i),
+		and the last bucket counts errors of 16ms or more.
+	*/
+	typedef struct HLVR_TimingStats {
+		uint32_t TickIntervalMilliseconds;
+		uint64_t TickCount;
+		/*! How late ticks woke up relative to their deadline */
+		float MeanLatenessMilliseconds;
+		float MaxLatenessMilliseconds;
+		uint32_t LatenessHistogram[HLVR_TIMING_HISTOGRAM_BUCKETS];
+		/*! How far the measured time between ticks was from the tick interval */
+		uint32_t TimestepErrorHistogram[HLVR_TIMING_HISTOGRAM_BUCKETS];
+	} HLVR_TimingStats;
+
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_GetTimingStats(HLVR_System* system, HLVR_TimingStats* outStats);
+
+
+	/*! Options for running haptics updates on a dedicated thread. @see HLVR_System_EnableRealtimeHaptics */
+	typedef struct HLVR_RealtimeHapticsOptions {
+		/*! Nonzero to ask for the highest thread priority the OS allows */
+		uint32_t RaisePriority;
+		/*! CPUs the thread may run on, one bit each. 0 leaves the choice to the OS. */
+		uint64_t AffinityMask;
+		/*! How long before each tick the thread stops sleeping and starts spinning, in microseconds. At most 5000. */
+		uint32_t SpinMicroseconds;
+	} HLVR_RealtimeHapticsOptions;
+
+	/*! Run haptics updates on a dedicated thread, which sleeps and then spins until each tick is due, instead of on a timer.
+		Tick timing is steadier, at the cost of some CPU time. Calling this again restarts the thread with the new options.
+		Priority and affinity are best effort: if the OS refuses them, the thread runs without them. 
+		@see HLVR_System_GetRealtimeHapticsStats to find out what was granted.
+		@param options may be NULL, for raised priority, no affinity, and 1000us of spinning
+		@return HLVR_Error_InvalidArgument if SpinMicroseconds is out of range
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_EnableRealtimeHaptics(HLVR_System* system, const HLVR_RealtimeHapticsOptions* options);
+
+	/*! Go back to running haptics updates on a timer. Does nothing if the dedicated thread isn't running. */
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_DisableRealtimeHaptics(HLVR_System* system);
+
+	typedef struct HLVR_RealtimeHapticsStats {
+		/*! Nonzero while haptics updates run on the dedicated thread */
+		uint32_t Enabled;
+		/*! Whether the OS granted the requested priority and affinity */
+		uint32_t PriorityRaised;
+		uint32_t AffinityApplied;
+		/*! How late ticks woke up relative to their deadline, in either mode, since the system was created.
+			Percentiles are accurate to within 12.5%. */
+		uint64_t TickCount;
+		float LatenessP50Milliseconds;
+		float LatenessP99Milliseconds;
+		float MaxLatenessMilliseconds;
+	} HLVR_RealtimeHapticsStats;
+
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_GetRealtimeHapticsStats(HLVR_System* system, HLVR_RealtimeHapticsStats* outStats);
+
+
+	/*! Add an event to the timeline, taking ownership of it instead of copying it. 
+		On success the event is destroyed and *event is set to NULL; on failure the caller still owns it.
+		@see HLVR_Timeline_AddEvent
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_Timeline_AddEventMove(HLVR_Timeline* timeline, double timeOffsetSeconds, HLVR_Event** event);
+
+	/*! Transmit the timeline, moving its events into the effect instead of copying them. 
+		The timeline is left empty, but must still be destroyed.
+		@see HLVR_Timeline_Transmit
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_Timeline_TransmitMove(HLVR_Timeline* timeline, HLVR_System* system, HLVR_Effect* effect);
+
+
+	/*! Transmitting a timeline with the same events as a recent one reuses the already parsed effect.
+		These counters report how often that happened since the system was created.
+	*/
+	typedef struct HLVR_EffectCacheStats {
+		uint64_t Hits;
+		uint64_t Misses;
+		/*! Number of distinct timelines currently cached */
+		uint32_t Entries;
+	} HLVR_EffectCacheStats;
+
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_System_GetEffectCacheStats(HLVR_System* system, HLVR_EffectCacheStats* outStats);
+
+
+	/*! Bind instance to a new effect which plays the same events as source, with its own playback state. 
+		The events are shared rather than copied, so this is the cheap way to play one effect on many things at once.
+		If instance was already bound to an effect, that effect is released first, even if instantiating then fails.
+		@return HLVR_Error_EmptyHandle if source was never transmitted.
+			HLVR_Error_NoSuchHandle if the effect source was bound to has since been released.
+			HLVR_Error_InvalidArgument if source and instance are the same effect.
+	*/
+	HLVR_RETURN_EXP(HLVR_Result) HLVR_Effect_Instantiate(const HLVR_Effect* source, HLVR_Effect* instance);
+
 	
 
 #ifdef __cplusplus
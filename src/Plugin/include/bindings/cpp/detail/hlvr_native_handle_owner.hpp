@@ -98,6 +98,11 @@ namespace hlvr {
 			explicit operator bool() const noexcept {
 				return (bool)m_handle;
 			}
+
+			//Gives up ownership without destroying the handle, e.g. after an API call consumed it
+			typename Traits::native_handle_type* release() noexcept {
+				return m_handle.release();
+			}
 			native_handle_owner(typename Traits::deleter_type d) : m_handle{nullptr, d} {}
 
 			
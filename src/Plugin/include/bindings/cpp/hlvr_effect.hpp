@@ -3,6 +3,7 @@
 #include "detail/hlvr_native_handle_owner.hpp"
 #include "hlvr_error.hpp"
 #include "HLVR.h"
+#include "HLVR_Experimental.h"
 #include <cassert>
 
 namespace hlvr {
@@ -44,6 +45,24 @@ public:
 		}
 	}
 
+	//Makes another effect which plays the same events, with its own playback state
+	expected<effect, status_code> instantiate() const {
+		assert(m_handle);
+
+		auto potentialEffect = effect::make();
+		if (!potentialEffect) {
+			return potentialEffect;
+		}
+
+		status_code sc(HLVR_Effect_Instantiate(m_handle.get(), potentialEffect->native_handle()));
+		if (sc) {
+			return potentialEffect;
+		}
+		else {
+			return unexpected<status_code>(sc);
+		}
+	}
+
 	static expected<effect, status_code> make() {
 		return make_helper(&HLVR_Effect_Create);
 	}
@@ -98,6 +98,41 @@ public:
 		}
 	}
 
+	//Replaces samples with every tracked region. If nothing changed since sequence, returns HLVR_Ok_NoDataAvailable
+	//and leaves samples as they were.
+	status_code get_all_tracking(std::vector<HLVR_TrackingSample>& samples, uint64_t& sequence) {
+		assert(m_handle);
+		HLVR_TrackingSample buffer[HLVR_MAX_TRACKING_SAMPLES];
+		uint32_t count = 0;
+		auto ec = HLVR_System_Tracking_GetAll(m_handle.get(), buffer, HLVR_MAX_TRACKING_SAMPLES, &count, &sequence);
+		if (ec == HLVR_Ok) {
+			samples.assign(buffer, buffer + count);
+		}
+		return status_code(ec);
+	}
+
+	status_code get_tracking_time(uint64_t& microseconds) {
+		assert(m_handle);
+		return status_code(HLVR_System_Tracking_GetTime(m_handle.get(), &microseconds));
+	}
+
+	//The orientation of the region at a time from get_tracking_time, interpolated or extrapolated from recent samples
+	status_code get_orientation_at(uint32_t region, uint64_t microseconds, HLVR_Quaternion& orientation) {
+		assert(m_handle);
+		return status_code(HLVR_System_Tracking_GetOrientationAt(m_handle.get(), region, microseconds, &orientation));
+	}
+
+	//callback is called from a plugin thread whenever tracking changes, until unsubscribe_tracking
+	status_code subscribe_tracking(HLVR_TrackingCallback callback, void* user_data = nullptr) {
+		assert(m_handle);
+		return status_code(HLVR_System_Tracking_Subscribe(m_handle.get(), callback, user_data));
+	}
+
+	status_code unsubscribe_tracking() {
+		assert(m_handle);
+		return status_code(HLVR_System_Tracking_Unsubscribe(m_handle.get()));
+	}
+
 	status_code enable_tracking(uint32_t device_id) {
 		assert(m_handle);
 		return status_code(HLVR_System_Tracking_Enable(m_handle.get(), device_id));
@@ -108,6 +143,55 @@ public:
 		return status_code(HLVR_System_Tracking_Disable(m_handle.get(), device_id));
 	}
 
+	status_code set_haptics_tick_interval(uint32_t milliseconds) {
+		assert(m_handle);
+		return status_code(HLVR_System_SetHapticsTickInterval(m_handle.get(), milliseconds));
+	}
+
+	expected<HLVR_TimingStats, status_code> get_timing_stats() {
+		assert(m_handle);
+		HLVR_TimingStats stats = { 0 };
+		auto ec = HLVR_System_GetTimingStats(m_handle.get(), &stats);
+		if (HLVR_OK(ec)) {
+			return stats;
+		} else {
+			return make_unexpected(status_code(ec));
+		}
+	}
+
+	//options may be null, for the defaults
+	status_code enable_realtime_haptics(const HLVR_RealtimeHapticsOptions* options = nullptr) {
+		assert(m_handle);
+		return status_code(HLVR_System_EnableRealtimeHaptics(m_handle.get(), options));
+	}
+
+	status_code disable_realtime_haptics() {
+		assert(m_handle);
+		return status_code(HLVR_System_DisableRealtimeHaptics(m_handle.get()));
+	}
+
+	expected<HLVR_RealtimeHapticsStats, status_code> get_realtime_haptics_stats() {
+		assert(m_handle);
+		HLVR_RealtimeHapticsStats stats = { 0 };
+		auto ec = HLVR_System_GetRealtimeHapticsStats(m_handle.get(), &stats);
+		if (HLVR_OK(ec)) {
+			return stats;
+		} else {
+			return make_unexpected(status_code(ec));
+		}
+	}
+
+	expected<HLVR_EffectCacheStats, status_code> get_effect_cache_stats() {
+		assert(m_handle);
+		HLVR_EffectCacheStats stats = { 0 };
+		auto ec = HLVR_System_GetEffectCacheStats(m_handle.get(), &stats);
+		if (HLVR_OK(ec)) {
+			return stats;
+		} else {
+			return make_unexpected(status_code(ec));
+		}
+	}
+
 	
 	static expected<system, status_code> make() {
 		return make_helper(&HLVR_System_Create);
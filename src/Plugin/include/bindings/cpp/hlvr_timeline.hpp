@@ -9,6 +9,7 @@
 #include "hlvr_error.hpp"
 
 #include "HLVR.h"
+#include "HLVR_Experimental.h"
 #include <cassert>
 
 namespace hlvr {
@@ -30,6 +31,18 @@ public:
 		return status_code(HLVR_Timeline_AddEvent(m_handle.get(), timeOffsetFractionalSeconds, ev.native_handle()));
 	}
 
+	//Moves the event into the timeline instead of copying it. On success, ev is left empty.
+	status_code add_event(hlvr::event&& ev, double timeOffsetFractionalSeconds) {
+		assert(m_handle);
+		assert(ev);
+		HLVR_Event* raw = ev.native_handle();
+		auto sc = status_code(HLVR_Timeline_AddEventMove(m_handle.get(), timeOffsetFractionalSeconds, &raw));
+		if (raw == nullptr) {
+			ev.release();
+		}
+		return sc;
+	}
+
 	status_code transmit(hlvr::system& system, hlvr::effect& effect) const {
 		assert(m_handle);
 		assert(system);
@@ -39,6 +52,15 @@ public:
 		return status_code(sc);
 	}
 
+	//Moves the events into the effect instead of copying them, leaving the timeline empty
+	status_code transmit_move(hlvr::system& system, hlvr::effect& effect) {
+		assert(m_handle);
+		assert(system);
+		assert(effect);
+
+		return status_code(HLVR_Timeline_TransmitMove(m_handle.get(), system.native_handle(), effect.native_handle()));
+	}
+
 	expected<hlvr::effect, status_code> transmit(hlvr::system& system) const {
 		assert(m_handle);
 		assert(system);